@@ -19,6 +19,7 @@
 #define IO_HPP
 
 #include <iostream>
+#include <memory>
 
 template<typename T>
 class IO
@@ -30,6 +31,10 @@ public:
     virtual void enableInterrupt () { };
     virtual void disableInterrupt() { };
     
+    // Reading address returns the same value until the next
+    // scheduled event, so loops polling it can be skipped
+    virtual bool stable(T) const { return false; }
+    
     virtual ~IO() = default;
 };
 
@@ -46,6 +51,38 @@ public:
     {
         
     }
+    
+    virtual bool stable(T) const override
+    {
+        return true;
+    }
+    
+    // Shared stub without control block, costs no allocation
+    static std::shared_ptr<IO<T>> instance()
+    {
+        static DefaultIO<T> io;
+        return std::shared_ptr<IO<T>>(std::shared_ptr<IO<T>>(), &io);
+    }
+};
+
+// Device of processor before connect(): shared stub for
+// interfaces, nothing for concrete device classes
+template<typename Device>
+struct Unconnected
+{
+    static std::shared_ptr<Device> instance()
+    {
+        return nullptr;
+    }
+};
+
+template<typename T>
+struct Unconnected<IO<T>>
+{
+    static std::shared_ptr<IO<T>> instance()
+    {
+        return DefaultIO<T>::instance();
+    }
 };
 
 #endif /* IO_HPP */
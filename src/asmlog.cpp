@@ -17,87 +17,73 @@
 
 #include <cstdint>
 #include <iomanip>
-#include <iostream>
+#include <ostream>
 
 #include "cpu.hpp"
 #include "asmlog.hpp"
 
 template<class T>
-void Asmlog::print(int width, std::string prefix, T value)
+void Asmlog::print(std::ostream & out, int width, std::string prefix, T value)
 {
-    std::cout << std::setfill(delimiter) << prefix
-              << std::setfill(filler) << std::setw(width) << std::right << std::hex << unsigned(value);
+    out << std::setfill(delimiter) << prefix
+        << std::setfill(filler) << std::setw(width) << std::right << std::hex << unsigned(value);
 }
 
-void Asmlog::printDivider(int width)
+void Asmlog::printDivider(std::ostream & out, int width)
 {
-    std::cout << std::setfill(delimiter) << std::setw(width);
+    out << std::setfill(delimiter) << std::setw(width);
 }
 
-void Asmlog::log(uint16_t counter, const Cpu * cpu)
+void Asmlog::print(std::ostream & out, const Record & record)
 {
-    auto opcode  = cpu -> opcode;
-    auto command = cpu -> commands[opcode];
+    auto & command = Cpu::commands[record.opcode];
+    auto & registers = record.registers;
     
-    std::cout << std::uppercase;
+    out << std::uppercase;
 
-    print(4, "0x", counter);
-    print(2,  " ", opcode);
+    print(out, 4, "0x", record.counter);
+    print(out, 2,  " ", record.opcode);
 
-    if (command.addrmod == &Cpu::DIR)
+    if (command.isIndirect())
     {
-        auto lo = cpu -> read(counter + 1);
-        auto hi = cpu -> read(counter + 2);
+        print(out, 2, " ",  record.operands[0]);
+        print(out, 2, " ",  record.operands[1]);
+        print(out, 2, " $", record.value);
 
-        auto value = cpu -> read((hi << 8) | lo);
-
-        print(2, " ",  lo);
-        print(2, " ",  hi);
-        print(2, " $", value);
-
-        printDivider(6);
+        printDivider(out, 6);
     }
-    else if (command.addrmod == &Cpu::IMM)
+    else if (command.isImmediate())
     {
-        auto value = cpu -> read(counter + 1);
-        
-        print(2, " ", value);
-        printDivider(13);
+        print(out, 2, " ", record.operands[0]);
+        printDivider(out, 13);
     }
     else
     {
-        printDivider(16);
+        printDivider(out, 16);
     }
 
-    std::cout << std::right << command.name;
+    out << std::right << command.name;
 
-    print(2, " A:", cpu -> registers[cpu -> A]);
-    print(2, " B:", cpu -> registers[cpu -> B]);
-    print(2, " C:", cpu -> registers[cpu -> C]);
-    print(2, " D:", cpu -> registers[cpu -> D]);
-    print(2, " E:", cpu -> registers[cpu -> E]);
-    print(2, " H:", cpu -> registers[cpu -> H]);
-    print(2, " L:", cpu -> registers[cpu -> L]);
+    print(out, 2, " A:", registers[Cpu::A]);
+    print(out, 2, " B:", registers[Cpu::B]);
+    print(out, 2, " C:", registers[Cpu::C]);
+    print(out, 2, " D:", registers[Cpu::D]);
+    print(out, 2, " E:", registers[Cpu::E]);
+    print(out, 2, " H:", registers[Cpu::H]);
+    print(out, 2, " L:", registers[Cpu::L]);
 
-    auto printReg = [&](uint8_t index)
-    {
-        auto address = cpu -> readpair(index);
-        auto value   = cpu -> read(address);
-        
-        print(2, " $", value);
-    };
-    
-    printReg(cpu -> BC);
-    printReg(cpu -> DE);
-    printReg(cpu -> HL);
+    for (auto value : record.memory) {
+        print(out, 2, " $", value);
+    }
 
-    std::cout << "  S="  << unsigned(cpu ->status.GetSign());
-    std::cout << "  Z="  << unsigned(cpu ->status.GetZero());
-    std::cout << "  AC=" << unsigned(cpu ->status.GetAux());
-    std::cout << "  P="  << unsigned(cpu ->status.GetParity());
-    std::cout << "  C="  << unsigned(cpu ->status.GetCarry());
+    // Flags in status register order
+    out << "  S="  << unsigned((record.status >> 7) & 1);
+    out << "  Z="  << unsigned((record.status >> 6) & 1);
+    out << "  AC=" << unsigned((record.status >> 4) & 1);
+    out << "  P="  << unsigned((record.status >> 2) & 1);
+    out << "  C="  << unsigned((record.status >> 0) & 1);
 
-    print(4, "  0x", cpu -> stack);
+    print(out, 4, "  0x", record.stack);
     
-    std::cout << std::endl;
+    out << '\n';
 }
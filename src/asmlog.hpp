@@ -19,10 +19,12 @@
 #define ASMLOG_HPP
 
 #include <cstdint>
+#include <ostream>
 #include <string>
 
-class Cpu;
+#include "trace.hpp"
 
+// Text form of trace records
 class Asmlog
 {
 private:
@@ -30,12 +32,12 @@ private:
     constexpr static char filler    = '0';
     
     template<typename T>
-    static void print(int width, std::string prefix, T value);
+    static void print(std::ostream & out, int width, std::string prefix, T value);
     
-    static void printDivider(int width);
+    static void printDivider(std::ostream & out, int width);
     
 public:
-    static void log(uint16_t counter, const Cpu * cpu);
+    static void print(std::ostream & out, const Record & record);
 };
 
 #endif /* ASMLOG_HPP */
@@ -0,0 +1,730 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "bdos.hpp"
+
+// File control block fields
+enum : uint16_t
+{
+    Drive   = 0,    // 0 - default, 1 - A, 2 - B ...
+    Name    = 1,    // 8 characters of name and 3 of type
+    Extent  = 12,   // Extent of 128 records, low 5 bits
+    S2      = 14,   // Extent, high bits
+    Count   = 15,   // Records in current extent
+    Rename  = 16,   // New name of rename
+    Current = 32,   // Record in current extent
+    Random  = 33    // Random record R0, R1, R2
+};
+
+static const uint16_t recordSize = 128;
+
+// Records of one directory entry
+static const uint32_t extentRecords = 0x80;
+
+// Characters CP/M doesn't allow in file names
+static const std::string reserved = "<>.,;:=?*[]|/\\\"";
+
+// Name of host file in FCB form or empty
+// string when it doesn't fit into 8.3
+static std::string fcbname(const std::string & host)
+{
+    auto dot = host.rfind('.');
+    
+    auto base = host.substr(0, dot);
+    auto type = dot == std::string::npos ? std::string() : host.substr(dot + 1);
+    
+    if (base.empty() || base.size() > 8 || type.size() > 3) {
+        return std::string();
+    }
+    
+    base.resize(8, ' ');
+    type.resize(3, ' ');
+    
+    auto name = base + type;
+    
+    for (auto & symbol : name)
+    {
+        if (symbol == '.' || symbol == '?' || symbol == '*') {
+            return std::string();
+        }
+        
+        symbol = (char) std::toupper((unsigned char) symbol);
+    }
+    
+    return name;
+}
+
+// Lowercase host name of FCB name or empty string when name
+// has characters outside of CP/M set or spaces inside
+static std::string hostname(const std::string & name)
+{
+    std::string host;
+    
+    for (std::size_t i = 0; i < name.size(); i++)
+    {
+        auto symbol = (unsigned char) name[i];
+        
+        if (i == 8 && name.compare(8, 3, "   ") != 0) {
+            host += '.';
+        }
+        
+        if (symbol == ' ') {
+            continue;
+        }
+        
+        // Name and type are padded with spaces only at the end
+        bool inside = i != 0 && i != 8 && name[i - 1] == ' ';
+        
+        if (symbol < 0x21 || symbol > 0x7E || reserved.find((char) symbol) != std::string::npos || inside) {
+            return std::string();
+        }
+        
+        host += (char) std::tolower(symbol);
+    }
+    
+    // Base name is required
+    return name[0] == ' ' ? std::string() : host;
+}
+
+Bdos::Bdos(std::shared_ptr<Console> console, std::string directory, std::istream & input) :
+    console(std::move(console)), directory(std::move(directory)), input(input)
+{
+    
+}
+
+void Bdos::install(Cpu & cpu, std::shared_ptr<Bdos> bdos, uint16_t top)
+{
+    cpu.setMemory(0x0005, 0xC3); // 0005: JMP top
+    cpu.setMemory(0x0006, (uint8_t) (top & 0xFF));
+    cpu.setMemory(0x0007, (uint8_t) (top >> 8));
+    
+    cpu.addTrap(0x0005, std::move(bdos));
+}
+
+// Function number in C, byte parameter in E, address in DE.
+// Result is returned in HL, copied to A and B
+void Bdos::call(Cpu & cpu)
+{
+    uint8_t  function = cpu.getRegister(Cpu::C);
+    uint8_t  data     = cpu.getRegister(Cpu::E);
+    uint16_t address  = cpu.getPair(Cpu::DE);
+    
+    uint16_t result = 0x0000;
+    uint32_t record = 0;
+    
+    switch (function)
+    {
+        case 0x00: // System reset
+            cpu.setCounter(0x0000);
+            return;
+            
+        case 0x01: // Console input
+            result = readChar();
+            break;
+            
+        case 0x02: // Console output
+            console -> put(data);
+            break;
+            
+        case 0x06: // Direct console I/O
+            result = directIO(data);
+            break;
+            
+        case 0x09: // Print string
+            print(cpu, address);
+            break;
+            
+        case 0x0A: // Read console buffer
+            readLine(cpu, address);
+            break;
+            
+        case 0x0B: // Get console status
+            result = status();
+            break;
+            
+        case 0x0C: // Return version number, CP/M 2.2
+            result = 0x0022;
+            break;
+            
+        case 0x0D: // Reset disk system
+            dma   = 0x0080;
+            drive = 0x00;
+            break;
+            
+        case 0x0E: // Select disk
+            drive = data & 0x0F;
+            break;
+            
+        case 0x0F: // Open file
+            result = open(cpu, address);
+            break;
+            
+        case 0x10: // Close file
+            result = close(cpu, address);
+            break;
+            
+        case 0x11: // Search for first
+            result = search(cpu, address);
+            break;
+            
+        case 0x12: // Search for next
+            result = found(cpu);
+            break;
+            
+        case 0x13: // Delete file
+            result = erase(cpu, address);
+            break;
+            
+        case 0x14: // Read sequential
+            record = position(cpu, address);
+            result = read(cpu, address, record);
+            
+            if (result == 0x00) {
+                seek(cpu, address, record + 1);
+            }
+            break;
+            
+        case 0x15: // Write sequential
+            record = position(cpu, address);
+            result = write(cpu, address, record);
+            
+            if (result == 0x00) {
+                seek(cpu, address, record + 1);
+            }
+            break;
+            
+        case 0x16: // Make file
+            result = make(cpu, address);
+            break;
+            
+        case 0x17: // Rename file
+            result = rename(cpu, address);
+            break;
+            
+        case 0x18: // Return login vector
+            result = (uint16_t) (1 << drive);
+            break;
+            
+        case 0x19: // Return current disk
+            result = drive;
+            break;
+            
+        case 0x1A: // Set DMA address
+            dma = address;
+            break;
+            
+        case 0x20: // Set or get user code
+            if (data == 0xFF) {
+                result = user;
+            }
+            else {
+                user = data & 0x0F;
+            }
+            break;
+            
+        case 0x21: // Read random
+        case 0x22: // Write random
+        case 0x28: // Write random with zero fill
+            record = random(cpu, address);
+            
+            // R2 must be zero
+            if (record > 0xFFFF)
+            {
+                result = 0x06;
+                break;
+            }
+            
+            result = function == 0x21 ? read(cpu, address, record) : write(cpu, address, record);
+            
+            // Sequential access continues from the record
+            if (result == 0x00) {
+                seek(cpu, address, record);
+            }
+            break;
+            
+        case 0x23: // Compute file size
+            result = size(cpu, address);
+            break;
+            
+        case 0x24: // Set random record
+            random(cpu, address, position(cpu, address));
+            break;
+            
+        default:
+            break;
+    }
+    
+    cpu.setPair(Cpu::HL, result);
+    
+    cpu.setRegister(Cpu::A, result & 0xFF);
+    cpu.setRegister(Cpu::B, result >> 8);
+}
+
+#pragma mark -
+#pragma mark Console
+
+// Host terminal echoes input itself
+uint8_t Bdos::readChar()
+{
+    // Prompt must be visible before waiting
+    console -> flush();
+    
+    int data = input.get();
+    
+    if (data == std::char_traits<char>::eof()) {
+        return 0x1A;
+    }
+    
+    return data == '\n' ? 0x0D : (uint8_t) data;
+}
+
+uint8_t Bdos::directIO(uint8_t data)
+{
+    if (data == 0xFF) {
+        return status() ? readChar() : 0x00;
+    }
+    
+    if (data == 0xFE) {
+        return status();
+    }
+    
+    console -> put(data);
+    return 0x00;
+}
+
+// String without '$' ends after whole address space
+void Bdos::print(Cpu & cpu, uint16_t address)
+{
+    for (uint32_t i = 0; i < 0x10000; i++)
+    {
+        uint8_t data = cpu.getMemory((uint16_t) (address + i));
+        
+        if (data == '$') {
+            break;
+        }
+        
+        console -> put(data);
+    }
+}
+
+// Buffer holds maximum length, read length and characters
+void Bdos::readLine(Cpu & cpu, uint16_t address)
+{
+    console -> flush();
+    
+    std::string line;
+    std::getline(input, line);
+    
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+    
+    auto length = (uint8_t) std::min<std::size_t>(line.size(), cpu.getMemory(address));
+    
+    for (uint8_t i = 0; i < length; i++) {
+        cpu.setMemory(address + 2 + i, (uint8_t) line[i]);
+    }
+    
+    cpu.setMemory(address + 1, length);
+}
+
+// Only characters already buffered by stream are ready
+uint8_t Bdos::status()
+{
+    return input.rdbuf() -> in_avail() > 0 ? 0xFF : 0x00;
+}
+
+#pragma mark -
+#pragma mark Files
+
+uint8_t Bdos::open(Cpu & cpu, uint16_t fcb)
+{
+    if (file(name(cpu, fcb)) == nullptr) {
+        return 0xFF;
+    }
+    
+    cpu.setMemory(fcb + S2, 0x00);
+    
+    // Records of opened extent
+    uint32_t first = position(cpu, fcb) & ~0x7F;
+    uint32_t total = records(name(cpu, fcb));
+    
+    cpu.setMemory(fcb + Count, (uint8_t) std::min<uint32_t>(total > first ? total - first : 0, extentRecords));
+    
+    return 0x00;
+}
+
+uint8_t Bdos::close(Cpu & cpu, uint16_t fcb)
+{
+    auto name = this -> name(cpu, fcb);
+    auto file = files.find(name);
+    
+    if (file != files.end())
+    {
+        files.erase(file);
+        return 0x00;
+    }
+    
+    return match(name).empty() ? 0xFF : 0x00;
+}
+
+uint8_t Bdos::search(Cpu & cpu, uint16_t fcb)
+{
+    // Question mark in drive matches all files
+    auto pattern = cpu.getMemory(fcb + Drive) == '?' ? std::string(11, '?') : name(cpu, fcb);
+    
+    entries.clear();
+    next = 0;
+    
+    for (auto & host : match(pattern))
+    {
+        auto name  = fcbname(host);
+        auto total = records(name);
+        
+        // Directory entry per extent
+        for (uint32_t extent = 0; extent == 0 || extent * extentRecords < total; extent++) {
+            entries.push_back({ name, (uint16_t) extent, (uint8_t) std::min<uint32_t>(total - extent * extentRecords, extentRecords) });
+        }
+    }
+    
+    return found(cpu);
+}
+
+uint8_t Bdos::found(Cpu & cpu)
+{
+    if (next >= entries.size()) {
+        return 0xFF;
+    }
+    
+    auto & entry = entries[next++];
+    
+    for (uint16_t i = 0; i < 32; i++) {
+        cpu.setMemory(dma + i, 0x00);
+    }
+    
+    cpu.setMemory(dma, user);
+    
+    for (uint16_t i = 0; i < 11; i++) {
+        cpu.setMemory(dma + Name + i, (uint8_t) entry.name[i]);
+    }
+    
+    cpu.setMemory(dma + Extent, entry.extent & 0x1F);
+    cpu.setMemory(dma + S2,     (uint8_t) (entry.extent >> 5));
+    cpu.setMemory(dma + Count,  entry.records);
+    
+    // Entry is the first of four in buffer
+    return 0x00;
+}
+
+uint8_t Bdos::erase(Cpu & cpu, uint16_t fcb)
+{
+    auto hosts = match(name(cpu, fcb));
+    
+    for (auto & host : hosts)
+    {
+        files.erase(fcbname(host));
+        std::remove(path(host).c_str());
+    }
+    
+    return hosts.empty() ? 0xFF : 0x00;
+}
+
+uint8_t Bdos::make(Cpu & cpu, uint16_t fcb)
+{
+    auto name = this -> name(cpu, fcb);
+    auto host = hostname(name);
+    
+    if (host.empty()) {
+        return 0xFF;
+    }
+    
+    files.erase(name);
+    
+    std::fstream stream(path(host), std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+    
+    if (!stream.is_open()) {
+        return 0xFF;
+    }
+    
+    files[name] = std::move(stream);
+    
+    cpu.setMemory(fcb + S2,    0x00);
+    cpu.setMemory(fcb + Count, 0x00);
+    
+    return 0x00;
+}
+
+uint8_t Bdos::rename(Cpu & cpu, uint16_t fcb)
+{
+    auto name  = this -> name(cpu, fcb);
+    auto hosts = match(name);
+    auto host  = hostname(this -> name(cpu, fcb + Rename));
+    
+    if (hosts.empty() || host.empty()) {
+        return 0xFF;
+    }
+    
+    files.erase(name);
+    
+    return std::rename(path(hosts.front()).c_str(), path(host).c_str()) == 0 ? 0x00 : 0xFF;
+}
+
+uint8_t Bdos::size(Cpu & cpu, uint16_t fcb)
+{
+    auto name = this -> name(cpu, fcb);
+    
+    if (match(name).empty()) {
+        return 0xFF;
+    }
+    
+    random(cpu, fcb, records(name));
+    return 0x00;
+}
+
+// Last record is padded with Ctrl-Z
+uint8_t Bdos::read(Cpu & cpu, uint16_t fcb, uint32_t record)
+{
+    auto file = this -> file(name(cpu, fcb));
+    
+    if (file == nullptr) {
+        return 0x01;
+    }
+    
+    char data[recordSize];
+    
+    file -> clear();
+    file -> seekg((std::streamoff) record * recordSize);
+    file -> read(data, recordSize);
+    
+    auto count = file -> gcount();
+    file -> clear();
+    
+    // End of file
+    if (count == 0) {
+        return 0x01;
+    }
+    
+    std::fill(data + count, data + recordSize, 0x1A);
+    
+    for (uint16_t i = 0; i < recordSize; i++) {
+        cpu.setMemory(dma + i, (uint8_t) data[i]);
+    }
+    
+    return 0x00;
+}
+
+uint8_t Bdos::write(Cpu & cpu, uint16_t fcb, uint32_t record)
+{
+    auto file = this -> file(name(cpu, fcb));
+    
+    if (file == nullptr) {
+        return 0x02;
+    }
+    
+    char data[recordSize];
+    
+    for (uint16_t i = 0; i < recordSize; i++) {
+        data[i] = (char) cpu.getMemory(dma + i);
+    }
+    
+    file -> clear();
+    file -> seekp((std::streamoff) record * recordSize);
+    file -> write(data, recordSize);
+    
+    if (!*file)
+    {
+        file -> clear();
+        return 0x02;
+    }
+    
+    // Extent grows up to written record
+    uint8_t count = (record & 0x7F) + 1;
+    
+    if (cpu.getMemory(fcb + Count) < count) {
+        cpu.setMemory(fcb + Count, count);
+    }
+    
+    return 0x00;
+}
+
+#pragma mark -
+#pragma mark File control block
+
+uint32_t Bdos::position(Cpu & cpu, uint16_t fcb)
+{
+    return ((uint32_t) (cpu.getMemory(fcb + S2) & 0x3F) << 12)
+         | ((uint32_t) (cpu.getMemory(fcb + Extent) & 0x1F) << 7)
+         |  (uint32_t) (cpu.getMemory(fcb + Current) & 0x7F);
+}
+
+// Record count is updated when extent changes
+void Bdos::seek(Cpu & cpu, uint16_t fcb, uint32_t record)
+{
+    bool changed = (position(cpu, fcb) >> 7) != (record >> 7);
+    
+    cpu.setMemory(fcb + S2,      (record >> 12) & 0x3F);
+    cpu.setMemory(fcb + Extent,  (record >> 7)  & 0x1F);
+    cpu.setMemory(fcb + Current,  record        & 0x7F);
+    
+    if (changed)
+    {
+        uint32_t first = record & ~0x7F;
+        uint32_t total = records(name(cpu, fcb));
+        
+        cpu.setMemory(fcb + Count, (uint8_t) std::min<uint32_t>(total > first ? total - first : 0, extentRecords));
+    }
+}
+
+uint32_t Bdos::random(Cpu & cpu, uint16_t fcb)
+{
+    return (uint32_t) cpu.getMemory(fcb + Random)
+         | (uint32_t) cpu.getMemory(fcb + Random + 1) << 8
+         | (uint32_t) cpu.getMemory(fcb + Random + 2) << 16;
+}
+
+void Bdos::random(Cpu & cpu, uint16_t fcb, uint32_t record)
+{
+    cpu.setMemory(fcb + Random,     record & 0xFF);
+    cpu.setMemory(fcb + Random + 1, (record >> 8)  & 0xFF);
+    cpu.setMemory(fcb + Random + 2, (record >> 16) & 0xFF);
+}
+
+std::string Bdos::name(Cpu & cpu, uint16_t fcb)
+{
+    std::string name(11, ' ');
+    
+    for (uint16_t i = 0; i < 11; i++) {
+        name[i] = (char) std::toupper(cpu.getMemory(fcb + Name + i) & 0x7F);
+    }
+    
+    return name;
+}
+
+#pragma mark -
+#pragma mark Host files
+
+std::vector<std::string> Bdos::match(const std::string & pattern) const
+{
+    std::vector<std::string> hosts;
+    
+    auto folder = opendir(directory.c_str());
+    
+    if (folder == nullptr) {
+        return hosts;
+    }
+    
+    while (auto entry = readdir(folder))
+    {
+        std::string host = entry -> d_name;
+        
+        struct stat info;
+        
+        if (host[0] == '.' || stat(path(host).c_str(), &info) != 0 || !S_ISREG(info.st_mode)) {
+            continue;
+        }
+        
+        auto name = fcbname(host);
+        
+        if (name.empty()) {
+            continue;
+        }
+        
+        bool matches = true;
+        
+        for (std::size_t i = 0; i < 11 && matches; i++) {
+            matches = pattern[i] == '?' || pattern[i] == name[i];
+        }
+        
+        if (matches) {
+            hosts.push_back(host);
+        }
+    }
+    
+    closedir(folder);
+    
+    std::sort(hosts.begin(), hosts.end());
+    return hosts;
+}
+
+std::string Bdos::path(const std::string & host) const
+{
+    return directory + "/" + host;
+}
+
+// Opened file may have unwritten buffer, others are not opened
+uint32_t Bdos::records(const std::string & name)
+{
+    uint64_t size = 0;
+    auto found = files.find(name);
+    
+    if (found != files.end())
+    {
+        auto & file = found -> second;
+        
+        file.clear();
+        file.seekg(0, std::ios::end);
+        
+        size = (uint64_t) file.tellg();
+    }
+    else
+    {
+        auto hosts = match(name);
+        struct stat info;
+        
+        if (!hosts.empty() && stat(path(hosts.front()).c_str(), &info) == 0) {
+            size = (uint64_t) info.st_size;
+        }
+    }
+    
+    return (uint32_t) ((size + recordSize - 1) / recordSize);
+}
+
+std::fstream * Bdos::file(const std::string & name)
+{
+    auto found = files.find(name);
+    
+    if (found != files.end()) {
+        return &found -> second;
+    }
+    
+    auto hosts = match(name);
+    
+    if (hosts.empty()) {
+        return nullptr;
+    }
+    
+    auto path = this -> path(hosts.front());
+    std::fstream stream(path, std::ios::in | std::ios::out | std::ios::binary);
+    
+    // Read only file
+    if (!stream.is_open()) {
+        stream.open(path, std::ios::in | std::ios::binary);
+    }
+    
+    if (!stream.is_open()) {
+        return nullptr;
+    }
+    
+    return &(files[name] = std::move(stream));
+}
@@ -0,0 +1,120 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BDOS_HPP
+#define BDOS_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "console.hpp"
+#include "cpu.hpp"
+#include "trap.hpp"
+
+// CP/M 2.2 BDOS executed by host. Console functions use
+// Console and input stream, every drive is mapped to the
+// same host directory, files are addressed by FCB name
+class Bdos : public Trap
+{
+private:
+    std::shared_ptr<Console> console;
+    
+    // Host directory with files
+    std::string directory;
+    
+    std::istream & input;
+    
+    // Disk buffer of file operations
+    uint16_t dma = 0x0080;
+    
+    uint8_t drive = 0x00;
+    uint8_t user  = 0x00;
+    
+    // Host files opened by FCB operations
+    std::map<std::string, std::fstream> files;
+    
+    // Directory entries of search first, returned one per call
+    struct Entry
+    {
+        std::string name;     // FCB name and type
+        uint16_t    extent;   // Extent number of file
+        uint8_t     records;  // Records in extent
+    };
+    
+    std::vector<Entry> entries;
+    std::size_t next = 0;
+    
+    // Console
+    uint8_t readChar();
+    uint8_t directIO(uint8_t data);
+    void    print(Cpu & cpu, uint16_t address);
+    void    readLine(Cpu & cpu, uint16_t address);
+    uint8_t status();
+    
+    // Files
+    uint8_t open  (Cpu & cpu, uint16_t fcb);
+    uint8_t close (Cpu & cpu, uint16_t fcb);
+    uint8_t search(Cpu & cpu, uint16_t fcb);
+    uint8_t found (Cpu & cpu);
+    uint8_t erase (Cpu & cpu, uint16_t fcb);
+    uint8_t make  (Cpu & cpu, uint16_t fcb);
+    uint8_t rename(Cpu & cpu, uint16_t fcb);
+    uint8_t size  (Cpu & cpu, uint16_t fcb);
+    
+    // Read or write record at FCB position
+    uint8_t read  (Cpu & cpu, uint16_t fcb, uint32_t record);
+    uint8_t write (Cpu & cpu, uint16_t fcb, uint32_t record);
+    
+    // Record position kept in extent and current record
+    static uint32_t position(Cpu & cpu, uint16_t fcb);
+    void seek(Cpu & cpu, uint16_t fcb, uint32_t record);
+    
+    // Random record of R0, R1 and R2
+    static uint32_t random(Cpu & cpu, uint16_t fcb);
+    static void random(Cpu & cpu, uint16_t fcb, uint32_t record);
+    
+    // Name and type of FCB, 11 characters padded with spaces
+    static std::string name(Cpu & cpu, uint16_t fcb);
+    
+    // Host files matching FCB name, '?' matches any character
+    std::vector<std::string> match(const std::string & pattern) const;
+    
+    // Host path of FCB name
+    std::string path(const std::string & name) const;
+    
+    // Records of 128 bytes in file of FCB name
+    uint32_t records(const std::string & name);
+    
+    // Opened host file, opens it when needed
+    std::fstream * file(const std::string & name);
+    
+public:
+    Bdos(std::shared_ptr<Console> console, std::string directory = ".", std::istream & input = std::cin);
+    
+    virtual void call(Cpu & cpu) override;
+    
+    // Trap CP/M entry 0005. Jump at 0005 points to top
+    // of memory available for programs reading 0006
+    static void install(Cpu & cpu, std::shared_ptr<Bdos> bdos, uint16_t top = 0xFE00);
+};
+
+#endif /* BDOS_HPP */
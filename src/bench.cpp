@@ -0,0 +1,722 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "IO.hpp"
+#include "cpu.tpp"
+#include "cpubatch.hpp"
+#include "memory.hpp"
+
+// Programs starting at
+static const uint16_t offset = 0x0100;
+
+class Ram : public Memory
+{
+private:
+    // 64 KB
+    std::array<uint8_t, 64 * 1024> memory {};
+    
+    // Direct access to memory array
+    Pages table;
+    
+public:
+    Ram()
+    {
+        for (uint16_t page = 0; page < 256; page++) {
+            table.read[page] = table.write[page] = memory.data() + (page << 8);
+        }
+    }
+    
+    virtual uint8_t read(uint16_t address) const override {
+        return memory[address];
+    }
+    
+    virtual void write(uint16_t address, uint8_t data) override {
+        memory[address] = data;
+    }
+    
+    virtual const Pages & pages() const override {
+        return table;
+    }
+};
+
+// Same memory without page pointers. Cpu calls it through
+// IO, FlatCpu calls the final class without virtual dispatch
+class FlatRam final : public IO<uint16_t>
+{
+private:
+    std::array<uint8_t, 64 * 1024> memory {};
+    
+public:
+    virtual uint8_t read(uint16_t address) const override {
+        return memory[address];
+    }
+    
+    virtual void write(uint16_t address, uint8_t data) override {
+        memory[address] = data;
+    }
+};
+
+using FlatCpu = BasicCpu<FlatRam, IO<uint8_t>>;
+
+// Both status policies in one binary, see BasicStatus
+using EagerCpu = BasicCpu<IO<uint16_t>, IO<uint8_t>, Eager>;
+using LazyCpu  = BasicCpu<IO<uint16_t>, IO<uint8_t>, Lazy>;
+
+// Program leaving through OUT 00 at 0000
+template <class Processor>
+class Exit : public IO<uint8_t>
+{
+private:
+    Processor & cpu;
+    
+public:
+    bool done = false;
+    
+    // Cycles spent before OUT 00
+    uint64_t clock = 0;
+    
+    // Loop passes skipped before OUT 00
+    BlockCache::Statistics statistics;
+    
+    Exit(Processor & cpu) : cpu(cpu)
+    {
+        
+    }
+    
+    virtual uint8_t read(uint8_t) const override {
+        return 0x00;
+    }
+    
+    virtual void write(uint8_t port, uint8_t) override
+    {
+        if (port == 0x00 && !done)
+        {
+            done  = true;
+            clock = cpu.getClock();
+            
+            statistics = cpu.getCacheStatistics();
+        }
+    }
+};
+
+// BDOS printing nowhere, the same for every processor.
+// Other functions return zero like Bdos does for output
+template <class Processor>
+class Silent : public BasicTrap<Processor>
+{
+public:
+    virtual void call(Processor & cpu) override
+    {
+        // System reset
+        if (cpu.getRegister(Processor::C) == 0x00)
+        {
+            cpu.setCounter(0x0000);
+            return;
+        }
+        
+        cpu.setPair(Processor::HL, 0x0000);
+        
+        cpu.setRegister(Processor::A, 0x00);
+        cpu.setRegister(Processor::B, 0x00);
+    }
+};
+
+struct Options
+{
+    bool cache  = false;
+    
+    // pages: Ram with page pointers, virtual: FlatRam
+    // called through IO, template: FlatCpu over FlatRam
+    std::string memory = "pages";
+    
+    // eager or lazy status of Cpu over Ram,
+    // build option LAZY_FLAGS by default
+#ifdef LAZY_FLAGS
+    std::string flags = "lazy";
+#else
+    std::string flags = "eager";
+#endif
+    
+    // Lanes of CpuBatch, 0 runs single Cpu
+    unsigned batch = 0;
+    
+    // Skip busy-wait loops, skipped
+    // passes are reported apart
+    bool skip   = false;
+    
+    unsigned repeat = 5;
+    
+    // Instructions per run, exercisers
+    // run to the end by default
+    uint64_t limit = UINT64_MAX;
+    
+    std::string programs = "../asm/";
+    std::string json;
+};
+
+struct Result
+{
+    std::string name;
+    
+    // Executed, without skipped loop passes
+    uint64_t instructions = 0;
+    uint64_t cycles       = 0;
+    
+    uint64_t skippedInstructions = 0;
+    uint64_t skippedCycles       = 0;
+    
+    // Lane operations per group decoded by batch
+    double width = 0;
+    
+    // Program ended before limit in every repetition
+    bool completed = true;
+    
+    // Seconds of every repetition
+    std::vector<double> seconds;
+};
+
+#pragma mark -
+#pragma mark Programs
+
+// Instructions per run of synthetic loops, which never end
+static const uint64_t endless = 50 * 1000 * 1000;
+
+// Endless loops, one per operation class
+static const std::vector<std::pair<std::string, std::vector<uint8_t>>> synthetic
+{
+    {
+        "mov",
+        {
+            0x41,               // MOV  B, C
+            0x53,               // MOV  D, E
+            0x65,               // MOV  H, L
+            0x78,               // MOV  A, B
+            0x4A,               // MOV  C, D
+            0x5C,               // MOV  E, H
+            0x6F,               // MOV  L, A
+            0x3E, 0x12,         // MVI  A, 12
+            0xC3, 0x00, 0x01    // JMP  0100
+        }
+    },
+    {
+        "alu",
+        {
+            0x80,               // ADD  B
+            0x91,               // SUB  C
+            0xA2,               // ANA  D
+            0xAB,               // XRA  E
+            0xB4,               // ORA  H
+            0xBD,               // CMP  L
+            0x8F,               // ADC  A
+            0x9C,               // SBB  H
+            0xC6, 0x11,         // ADI  11
+            0x04,               // INR  B
+            0x0D,               // DCR  C
+            0x27,               // DAA
+            0x07,               // RLC
+            0xC3, 0x00, 0x01    // JMP  0100
+        }
+    },
+    {
+        "jump",
+        {
+            0x06, 0x00,         // MVI  B, 00
+            0x05,               // DCR  B
+            0xCA, 0x0A, 0x01,   // JZ   010A
+            0xC2, 0x02, 0x01,   // JNZ  0102
+            0x76,               // HLT
+            0xD2, 0x00, 0x01,   // JNC  0100
+            0xC3, 0x00, 0x01    // JMP  0100
+        }
+    },
+    {
+        "stack",
+        {
+            0x31, 0x00, 0xF0,   // LXI  SP, F000
+            0xC5,               // PUSH B
+            0xD5,               // PUSH D
+            0xE3,               // XTHL
+            0xD1,               // POP  D
+            0xC1,               // POP  B
+            0xF5,               // PUSH PSW
+            0xF1,               // POP  PSW
+            0xCD, 0x10, 0x01,   // CALL 0110
+            0xC3, 0x03, 0x01,   // JMP  0103
+            0xC9                // RET
+        }
+    },
+    {
+        "memory",
+        {
+            0x21, 0x00, 0x20,   // LXI  H, 2000
+            0x11, 0x00, 0x30,   // LXI  D, 3000
+            0x7E,               // MOV  A, M
+            0x12,               // STAX D
+            0x23,               // INX  H
+            0x13,               // INX  D
+            0x77,               // MOV  M, A
+            0x1A,               // LDAX D
+            0x32, 0x00, 0x40,   // STA  4000
+            0x3A, 0x01, 0x40,   // LDA  4001
+            0x34,               // INR  M
+            0xC3, 0x06, 0x01    // JMP  0106
+        }
+    }
+};
+
+// Exercisers from asm folder
+static const std::string exercisers[]
+{
+    "CPUTEST.com",
+    "8080.com",
+    "8080PRE.com",
+    "8080EXM.com",
+    "8080EX1.com",
+    "8080EXER.com"
+};
+
+#pragma mark -
+#pragma mark Measurement
+
+// Run image until it leaves through 0000 or limit is reached
+template <class Processor, class Storage>
+static Result measure(const std::string & name, const std::vector<uint8_t> & image, const Options & options)
+{
+    Result result;
+    result.name = name;
+    
+    for (unsigned repetition = 0; repetition < options.repeat; repetition++)
+    {
+        auto bus  = std::make_shared<Storage>();
+        auto cpu  = std::make_unique<Processor>();
+        auto exit = std::make_shared<Exit<Processor>>(*cpu);
+        
+        bus -> write(0x0000, 0xD3); // 0000: OUT 00
+        bus -> write(0x0001, 0x00);
+        bus -> write(0x0002, 0xC3); // 0002: JMP 0002
+        bus -> write(0x0003, 0x02);
+        bus -> write(0x0004, 0x00);
+        bus -> write(0x0005, 0xC3); // 0005: JMP FE00
+        bus -> write(0x0006, 0x00);
+        bus -> write(0x0007, 0xFE);
+        
+        for (std::size_t i = 0; i < image.size() && offset + i < 0x10000; i++) {
+            bus -> write((uint16_t) (offset + i), image[i]);
+        }
+        
+        cpu -> connect(bus);
+        cpu -> connect(exit);
+        
+        cpu -> addTrap(0x0005, std::make_shared<Silent<Processor>>());
+        cpu -> setCounter(offset);
+        
+        if (options.cache) {
+            cpu -> enableCache(true, options.skip);
+        }
+        
+        uint64_t instructions = 0;
+        uint64_t cycles = 0;
+        
+        auto start = std::chrono::steady_clock::now();
+        
+        while (!exit -> done && instructions < options.limit)
+        {
+            auto slice = (unsigned) std::min<uint64_t>(10000, options.limit - instructions);
+            
+            cycles += cpu -> step(slice);
+            instructions += slice;
+        }
+        
+        auto finish = std::chrono::steady_clock::now();
+        
+        auto statistics = cpu -> getCacheStatistics();
+        
+        // Rest of the last slice spins in JMP 0002
+        if (exit -> done)
+        {
+            uint64_t spin = (cycles - exit -> clock - 10) / 10;
+            
+            instructions -= spin;
+            cycles -= spin * 10;
+            
+            statistics = exit -> statistics;
+        }
+        
+        result.completed &= exit -> done;
+        
+        result.skippedInstructions = statistics.skippedOperations;
+        result.skippedCycles       = statistics.skippedCycles;
+        
+        result.instructions = instructions - result.skippedInstructions;
+        result.cycles       = cycles - result.skippedCycles;
+        result.seconds.push_back(std::chrono::duration<double>(finish - start).count());
+    }
+    
+    return result;
+}
+
+// Run image on every lane of batch until all lanes halt at 0000
+// or limit is reached. Lanes have no traps, BDOS at FE00 does
+// what Silent does in guest code
+static Result measureBatch(const std::string & name, const std::vector<uint8_t> & image, const Options & options)
+{
+    Result result;
+    result.name = name;
+    
+    for (unsigned repetition = 0; repetition < options.repeat; repetition++)
+    {
+        CpuBatch batch(options.batch);
+        
+        for (std::size_t lane = 0; lane < batch.size(); lane++)
+        {
+            batch.load(lane, 0x0000, { 0x76 });             // 0000: HLT
+            batch.load(lane, 0x0005, { 0xC3, 0x00, 0xFE }); // 0005: JMP FE00
+            
+            batch.load(lane, 0xFE00,
+            {
+                0x79,               // FE00: MOV  A, C
+                0xB7,               // FE01: ORA  A
+                0xCA, 0x00, 0x00,   // FE02: JZ   0000
+                0xAF,               // FE05: XRA  A
+                0x47,               // FE06: MOV  B, A
+                0x67,               // FE07: MOV  H, A
+                0x6F,               // FE08: MOV  L, A
+                0xC9                // FE09: RET
+            });
+            
+            std::vector<uint8_t> program(image.begin(), image.begin() + std::min<std::size_t>(image.size(), 0xFE00 - offset));
+            
+            batch.load(lane, offset, program);
+            batch.setCounter(lane, offset);
+        }
+        
+        auto halted = [&]
+        {
+            for (std::size_t lane = 0; lane < batch.size(); lane++)
+            {
+                if (!batch.isHalted(lane)) {
+                    return false;
+                }
+            }
+            
+            return true;
+        };
+        
+        auto start = std::chrono::steady_clock::now();
+        
+        for (uint64_t done = 0; done < options.limit && !halted(); done += 10000) {
+            batch.step(std::min<uint64_t>(10000, options.limit - done));
+        }
+        
+        auto finish = std::chrono::steady_clock::now();
+        
+        auto statistics = batch.getStatistics();
+        
+        result.completed &= halted();
+        
+        result.instructions = batch.getInstructions();
+        result.cycles       = batch.getCycles();
+        result.width        = (double) statistics.grouped / std::max<uint64_t>(statistics.groups, 1);
+        result.seconds.push_back(std::chrono::duration<double>(finish - start).count());
+    }
+    
+    return result;
+}
+
+static Result measure(const std::string & name, const std::vector<uint8_t> & image, const Options & options)
+{
+    if (options.batch > 0) {
+        return measureBatch(name, image, options);
+    }
+    
+    if (options.memory == "virtual") {
+        return measure<Cpu, FlatRam>(name, image, options);
+    }
+    
+    if (options.memory == "template") {
+        return measure<FlatCpu, FlatRam>(name, image, options);
+    }
+    
+    if (options.flags == "lazy") {
+        return measure<LazyCpu, Ram>(name, image, options);
+    }
+    
+    return measure<EagerCpu, Ram>(name, image, options);
+}
+
+static bool load(const std::string & path, std::vector<uint8_t> & image)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    image.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+#pragma mark -
+#pragma mark Report
+
+static double mean(const std::vector<double> & values)
+{
+    double sum = 0;
+    
+    for (auto value : values) {
+        sum += value;
+    }
+    
+    return sum / values.size();
+}
+
+static double deviation(const std::vector<double> & values)
+{
+    double average = mean(values);
+    double sum = 0;
+    
+    for (auto value : values) {
+        sum += (value - average) * (value - average);
+    }
+    
+    return std::sqrt(sum / values.size());
+}
+
+// Speed of every repetition in millions per second
+static std::vector<double> rates(const Result & result, uint64_t count)
+{
+    std::vector<double> rates;
+    
+    for (auto seconds : result.seconds) {
+        rates.push_back(count / seconds / 1e6);
+    }
+    
+    return rates;
+}
+
+static void print(const Result & result)
+{
+    auto mips = rates(result, result.instructions);
+    auto mhz  = rates(result, result.cycles);
+    
+    std::cout << std::left  << std::setw(14) << result.name << std::right;
+    std::cout << std::setw(10) << mean(mips) << " ± " << std::setw(6) << deviation(mips) << " MIPS";
+    std::cout << std::setw(10) << mean(mhz)  << " MHz";
+    std::cout << std::setw(10) << mean(result.seconds) * 1e9 / result.instructions << " ns/op";
+    
+    if (result.skippedInstructions > 0) {
+        std::cout << "   +" << result.skippedInstructions << " skipped";
+    }
+    
+    if (result.width > 0) {
+        std::cout << "   " << result.width << " lanes/group";
+    }
+    
+    std::cout << (result.completed ? "   completed" : "   stopped at limit") << std::endl;
+}
+
+static std::string json(const std::vector<Result> & results, const Options & options)
+{
+    std::ostringstream out;
+    
+    out << std::setprecision(6);
+    out << "{\n";
+    
+#ifdef SWITCH_DISPATCH
+    out << "  \"dispatch\": \"SWITCH\",\n";
+#else
+    out << "  \"dispatch\": \"TABLE\",\n";
+#endif
+    
+#ifdef LAZY_FLAGS
+    out << "  \"lazy_flags\": true,\n";
+#else
+    out << "  \"lazy_flags\": false,\n";
+#endif
+    
+    out << "  \"flags\": \"" << options.flags << "\",\n";
+    
+#ifdef JIT
+    out << "  \"jit\": true,\n";
+#else
+    out << "  \"jit\": false,\n";
+#endif
+    
+#ifdef PROFILE
+    out << "  \"profile\": true,\n";
+#else
+    out << "  \"profile\": false,\n";
+#endif
+    
+    out << "  \"cache\": " << (options.cache ? "true" : "false") << ",\n";
+    out << "  \"skip\": " << (options.skip ? "true" : "false") << ",\n";
+    out << "  \"memory\": \"" << options.memory << "\",\n";
+    out << "  \"batch\": " << options.batch << ",\n";
+    out << "  \"repeat\": " << options.repeat << ",\n";
+    
+    if (options.limit == UINT64_MAX) {
+        out << "  \"limit\": null,\n";
+    }
+    else {
+        out << "  \"limit\": " << options.limit << ",\n";
+    }
+    
+    out << "  \"results\": [\n";
+    
+    for (std::size_t index = 0; index < results.size(); index++)
+    {
+        auto & result = results[index];
+        
+        auto mips = rates(result, result.instructions);
+        auto mhz  = rates(result, result.cycles);
+        
+        out << "    {\n";
+        out << "      \"name\": \"" << result.name << "\",\n";
+        out << "      \"instructions\": " << result.instructions << ",\n";
+        out << "      \"cycles\": " << result.cycles << ",\n";
+        out << "      \"skipped_instructions\": " << result.skippedInstructions << ",\n";
+        out << "      \"skipped_cycles\": " << result.skippedCycles << ",\n";
+        out << "      \"lanes_per_group\": " << result.width << ",\n";
+        out << "      \"completed\": " << (result.completed ? "true" : "false") << ",\n";
+        out << "      \"mips\": " << mean(mips) << ",\n";
+        out << "      \"mips_stddev\": " << deviation(mips) << ",\n";
+        out << "      \"mhz\": " << mean(mhz) << ",\n";
+        out << "      \"mhz_stddev\": " << deviation(mhz) << ",\n";
+        out << "      \"ns_per_instruction\": " << mean(result.seconds) * 1e9 / result.instructions << ",\n";
+        out << "      \"seconds\": [";
+        
+        for (std::size_t i = 0; i < result.seconds.size(); i++) {
+            out << (i ? ", " : "") << result.seconds[i];
+        }
+        
+        out << "]\n";
+        out << "    }" << (index + 1 < results.size() ? "," : "") << "\n";
+    }
+    
+    out << "  ]\n";
+    out << "}\n";
+    
+    return out.str();
+}
+
+#pragma mark -
+#pragma mark Main
+
+// Usage: bench [--cache] [--skip] [--virtual | --template] [--batch lanes]
+//              [--flags eager | lazy] [--repeat N] [--limit N] [--asm folder/] [--json file] [name ...]
+int main(int argc, const char * argv[])
+{
+    Options options;
+    std::vector<std::string> filter;
+    
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool value = i + 1 < argc;
+        
+        if (argument == "--cache") {
+            options.cache = true;
+        }
+        else if (argument == "--skip") {
+            options.skip = true;
+        }
+        else if (argument == "--virtual" || argument == "--template") {
+            options.memory = argument.substr(2);
+        }
+        else if (argument == "--flags" && value) {
+            options.flags = argv[++i];
+        }
+        else if (argument == "--batch" && value) {
+            options.batch = (unsigned) std::max(std::stoi(argv[++i]), 0);
+        }
+        else if (argument == "--repeat" && value) {
+            options.repeat = std::max(std::stoi(argv[++i]), 1);
+        }
+        else if (argument == "--limit" && value) {
+            options.limit = std::stoull(argv[++i]);
+        }
+        else if (argument == "--asm" && value) {
+            options.programs = argv[++i];
+        }
+        else if (argument == "--json" && value) {
+            options.json = argv[++i];
+        }
+        else {
+            filter.push_back(argument);
+        }
+    }
+    
+    auto selected = [&](const std::string & name)
+    {
+        return filter.empty() || std::find(filter.begin(), filter.end(), name) != filter.end();
+    };
+    
+    std::vector<Result> results;
+    
+    Options loops = options;
+    loops.limit = std::min(options.limit, endless);
+    
+    for (auto & program : synthetic)
+    {
+        if (!selected(program.first)) {
+            continue;
+        }
+        
+        results.push_back(measure(program.first, program.second, loops));
+        
+        print(results.back());
+    }
+    
+    for (auto & exerciser : exercisers)
+    {
+        std::vector<uint8_t> image;
+        
+        if (!selected(exerciser)) {
+            continue;
+        }
+        
+        if (!load(options.programs + exerciser, image))
+        {
+            std::cerr << "File not found " << options.programs + exerciser << std::endl;
+            continue;
+        }
+        
+        results.push_back(measure(exerciser, image, options));
+        
+        print(results.back());
+    }
+    
+    if (!options.json.empty())
+    {
+        std::ofstream file(options.json);
+        file << json(results, options);
+    }
+
+    return 0;
+}
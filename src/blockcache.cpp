@@ -0,0 +1,434 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cpu.hpp"
+#include "blockcache.hpp"
+
+#pragma mark -
+#pragma mark Lookup
+
+const Block * BlockCache::miss(uint16_t counter)
+{
+    auto host = pages -> read[counter >> 8];
+    
+    // Memory mapped IO is never cached
+    if (host == nullptr) {
+        return nullptr;
+    }
+    
+    auto & page = directory[counter >> 8];
+    
+    if (page.empty()) {
+        page.resize(256);
+    }
+    
+    auto & block = page[counter & 0xFF];
+    
+    if (block == nullptr || block -> host != host)
+    {
+        // Block of another bank may be linked. It is not
+        // running, so the returned block is not stale
+        if (block != nullptr)
+        {
+            graveyard.push_back(std::move(block));
+            generations[counter >> 8]++;
+        }
+        
+        block = decode(counter, host);
+        cover(counter >> 8, *block);
+        
+        counters.misses++;
+    }
+    
+    // Operation crossing page boundary
+    if (block -> operations.empty()) {
+        return nullptr;
+    }
+    
+    return block.get();
+}
+
+#pragma mark -
+#pragma mark Decoding
+
+std::unique_ptr<Block> BlockCache::decode(uint16_t counter, const uint8_t * host) const
+{
+    auto block = std::make_unique<Block>();
+    
+    block -> host    = host;
+    block -> counter = counter;
+    
+    uint16_t offset = counter & 0xFF;
+    
+    while (block -> operations.size() < limit)
+    {
+        Decoded operation;
+        
+        operation.counter = (counter & 0xFF00) | offset;
+        operation.opcode  = host[offset];
+        
+        // Trapped address starts its own block
+        if (!block -> operations.empty() && traps != nullptr && traps -> contains(operation.counter)) {
+            break;
+        }
+        
+        auto & command = Cpu::commands[operation.opcode];
+        
+        uint16_t length = 1;
+        
+        if (command.addrmod == &Cpu::IMM) {
+            length = 2;
+        }
+        
+        if (command.addrmod == &Cpu::DIR) {
+            length = 3;
+        }
+        
+        // Operation crossing page is interpreted
+        if (offset + length > 0x100) {
+            break;
+        }
+        
+        operation.cycles = command.cycles;
+        operation.next   = operation.counter + length;
+        
+        if (command.addrmod == &Cpu::IMM) {
+            operation.address = operation.counter + 1;
+        }
+        
+        if (command.addrmod == &Cpu::DIR) {
+            operation.address = (uint16_t) (host[offset + 2] << 8) | host[offset + 1];
+        }
+        
+        if (command.addrmod == &Cpu::HLM || command.addrmod == &Cpu::IND) {
+            operation.resolved = false;
+        }
+        
+        block -> operations.push_back(operation);
+        block -> cycles += operation.cycles;
+        
+        if (terminates(operation.opcode)) {
+            break;
+        }
+        
+        offset += length;
+    }
+    
+    if (!block -> operations.empty())
+    {
+        block -> first = counter & 0xFF;
+        block -> last  = (block -> operations.back().next - 1) & 0xFF;
+    }
+    
+#if !defined(ASMLOG) && !defined(PROFILE)
+    // Skipped passes aren't logged nor counted
+    if (loops) {
+        block -> spin = spins(*block);
+    }
+#endif
+    
+#ifndef ASMLOG
+    // Log is written per operation
+    if (fusion) {
+        fuse(*block);
+    }
+#endif
+    
+    return block;
+}
+
+void BlockCache::fuse(Block & block)
+{
+    auto & operations = block.operations;
+    
+    for (std::size_t index = 0; index + 1 < operations.size(); index++)
+    {
+        auto & first = operations[index + 0];
+        auto & second = operations[index + 1];
+        
+        first.fusion = fusable(first.opcode, second.opcode);
+        
+        // Pairs never overlap
+        if (first.fusion != Fusion::None) {
+            index++;
+        }
+    }
+}
+
+// Most frequent pairs in CPUTEST and 8080EXM
+Fusion BlockCache::fusable(uint8_t first, uint8_t second)
+{
+    // Jcc
+    if ((second & 0xC7) == 0xC2)
+    {
+        // INR r, DCR r
+        if ((first & 0xC6) == 0x04 && (first & 0x38) != 0x30) {
+            return Fusion::Branch;
+        }
+        
+        // ADD r ... CMP r
+        if ((first & 0xC0) == 0x80 && (first & 0x07) != 0x06) {
+            return Fusion::Branch;
+        }
+        
+        // ADI ... CPI
+        if ((first & 0xC7) == 0xC6) {
+            return Fusion::Branch;
+        }
+    }
+    
+    // MOV r, M / INX H
+    if ((first & 0xC7) == 0x46 && first != 0x76 && second == 0x23) {
+        return Fusion::Increment;
+    }
+    
+    // MVI r or LXI / CALL
+    if (second == 0xCD)
+    {
+        if ((first & 0xC7) == 0x06 && first != 0x36) {
+            return Fusion::Call;
+        }
+        
+        if ((first & 0xCF) == 0x01) {
+            return Fusion::Call;
+        }
+    }
+    
+    return Fusion::None;
+}
+
+// Operations changing program counter, halting, switching
+// interrupts or IO which may remap memory end the block
+bool BlockCache::terminates(uint8_t opcode)
+{
+    switch (opcode)
+    {
+        case 0x76: // HLT
+        case 0xC3: // JMP
+        case 0xCB: // JMP
+        case 0xC9: // RET
+        case 0xD9: // RET
+        case 0xCD: // CALL
+        case 0xDD: // CALL
+        case 0xED: // CALL
+        case 0xFD: // CALL
+        case 0xE9: // PCHL
+        case 0xD3: // OUT
+        case 0xF3: // DI
+        case 0xFB: // EI
+            return true;
+    }
+    
+    if (opcode < 0xC0) {
+        return false;
+    }
+    
+    // Rcc, Jcc, Ccc, RST
+    switch (opcode & 0x07)
+    {
+        case 0x00:
+        case 0x02:
+        case 0x04:
+        case 0x07:
+            return true;
+    }
+    
+    return false;
+}
+
+#pragma mark -
+#pragma mark Invalidation
+
+void BlockCache::cover(uint8_t page, const Block & block)
+{
+    if (block.operations.empty()) {
+        return;
+    }
+    
+    auto & bits = code[page];
+    
+    for (uint16_t offset = block.first; offset <= block.last; offset++) {
+        bits[offset >> 6] |= 1ULL << (offset & 0x3F);
+    }
+}
+
+// Blocks of page not containing written byte survive,
+// code bitmap is rebuilt from them
+void BlockCache::invalidate(uint16_t address)
+{
+    uint8_t page   = address >> 8;
+    uint8_t offset = address & 0xFF;
+    
+    counters.invalidations++;
+    generations[page]++;
+    
+    for (auto & bits : code[page]) {
+        bits = 0;
+    }
+    
+    for (auto & block : directory[page])
+    {
+        if (block == nullptr || block -> operations.empty()) {
+            continue;
+        }
+        
+        if (block -> first <= offset && offset <= block -> last)
+        {
+            graveyard.push_back(std::move(block));
+            counters.dropped++;
+            
+            stale = true;
+            continue;
+        }
+        
+        cover(page, *block);
+    }
+}
+
+void BlockCache::drop(uint8_t page)
+{
+    for (auto & block : directory[page])
+    {
+        if (block != nullptr) {
+            graveyard.push_back(std::move(block));
+        }
+    }
+    
+    for (auto & bits : code[page]) {
+        bits = 0;
+    }
+    
+    generations[page]++;
+    stale = true;
+}
+
+void BlockCache::clear()
+{
+    for (std::size_t page = 0; page < 256; page++) {
+        drop(page);
+    }
+}
+
+// Only the last operation of block transfers control,
+// loop is the block jumping back to its first operation
+Spin BlockCache::spins(const Block & block)
+{
+    auto & operations = block.operations;
+    
+    if (operations.empty()) {
+        return Spin::None;
+    }
+    
+    auto & last = operations.back();
+    
+    bool jump = last.opcode == 0xC3 || last.opcode == 0xCB || (last.opcode & 0xC7) == 0xC2;
+    
+    if (!jump || last.address != block.counter) {
+        return Spin::None;
+    }
+    
+    auto opcode = [&](std::size_t index) { return operations[index].opcode; };
+    
+    // INR r or DCR r, r is not M
+    if (operations.size() == 2 && (opcode(0) & 0xC6) == 0x04 && (opcode(0) & 0x38) != 0x30 && opcode(1) == 0xC2) {
+        return Spin::Counter;
+    }
+    
+    // INX rp or DCX rp, MOV A and ORA with both halves of rp
+    if (operations.size() == 4 && (opcode(0) & 0xC7) == 0x03 && (opcode(0) & 0x30) != 0x30 && opcode(3) == 0xC2)
+    {
+        uint8_t hi = (opcode(0) >> 4) * 2;
+        uint8_t lo = hi + 1;
+        
+        if ((opcode(1) == (0x78 | hi) && opcode(2) == (0xB0 | lo)) ||
+            (opcode(1) == (0x78 | lo) && opcode(2) == (0xB0 | hi))) {
+            return Spin::Pair;
+        }
+    }
+    
+    for (std::size_t index = 0; index + 1 < operations.size(); index++)
+    {
+        auto code = opcode(index);
+        
+        bool store = code == 0x02 || code == 0x12 || code == 0x22 || code == 0x32  // STAX, SHLD, STA
+                  || code == 0x34 || code == 0x35 || code == 0x36                  // INR M, DCR M, MVI M
+                  || (code >= 0x70 && code <= 0x77);                               // MOV M, r and HLT
+        
+        // Stack, calls, OUT, EI and DI
+        if (store || (code >= 0xC0 && code != 0xDB && (code & 0xC7) != 0xC6)) {
+            return Spin::None;
+        }
+    }
+    
+    return Spin::Idle;
+}
+
+#pragma mark -
+#pragma mark Statistics
+
+uint32_t BlockCache::generation(uint8_t page) const
+{
+    return generations[page];
+}
+
+void BlockCache::skip(const Block & block, uint64_t passes)
+{
+    counters.skipped           += passes;
+    counters.skippedOperations += passes * block.operations.size();
+    counters.skippedCycles     += passes * block.cycles;
+}
+
+#ifdef PROFILE
+void BlockCache::account(const Block & block)
+{
+    if (block.passes == 0) {
+        return;
+    }
+    
+    for (auto & operation : block.operations) {
+        profiler.record(operation.counter, operation.opcode, block.passes, block.passes * operation.cycles);
+    }
+    
+    auto & last = block.operations.back();
+    profiler.record(last.counter, last.opcode, 0, block.extra);
+    
+    block.passes = 0;
+    block.extra  = 0;
+}
+
+void BlockCache::account()
+{
+    for (auto & page : directory)
+    {
+        for (auto & block : page)
+        {
+            if (block != nullptr) {
+                account(*block);
+            }
+        }
+    }
+    
+    for (auto & block : graveyard) {
+        account(*block);
+    }
+}
+#endif
+
+const BlockCache::Statistics & BlockCache::statistics() const
+{
+    return counters;
+}
@@ -0,0 +1,321 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BLOCKCACHE_HPP
+#define BLOCKCACHE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "memory.hpp"
+#include "trap.hpp"
+
+#ifdef PROFILE
+#include "profiler.hpp"
+#endif
+
+// Pairs of operations executed by a single handler.
+// The first operation never writes memory
+enum class Fusion : uint8_t
+{
+    None,
+    Branch,     // INR, DCR or ALU operation / Jcc
+    Increment,  // MOV r, M / INX H
+    Call        // MVI r or LXI / CALL
+};
+
+// Block jumping to itself, which can be skipped ahead
+enum class Spin : uint8_t
+{
+    None,
+    Idle,       // No stores, state may stay the same every pass
+    Counter,    // INR r or DCR r / JNZ
+    Pair        // INX rp or DCX rp / MOV A, hi / ORA lo / JNZ
+};
+
+// Operation with address mode resolved ahead of execution
+struct Decoded
+{
+    uint8_t  opcode   = 0x00;
+    uint8_t  cycles   = 0x00;    // Base cycles
+    
+    // Address is known at decode time, otherwise
+    // it depends on registers and is set at run time
+    bool     resolved = true;
+    
+    // Operation is fused with the following one
+    Fusion   fusion   = Fusion::None;
+    
+    uint16_t address = 0x0000;   // Immediate pointer or direct address
+    uint16_t counter = 0x0000;   // Address of operation
+    uint16_t next    = 0x0000;   // Address of following operation
+};
+
+struct Block;
+
+// Host code of leading operations of block, see Jit.
+// Returns cycles << 8 | number of operations executed
+typedef uint32_t (*Native)(void * cpu);
+
+// Successor of block found on previous run. Valid while
+// generation of successor page is unchanged
+struct Link
+{
+    const Block * block = nullptr;
+    uint32_t generation = 0;
+};
+
+// Straight line of operations ending with control transfer.
+// Block never crosses page boundary
+struct Block
+{
+    // Page storage block was decoded from
+    const uint8_t * host = nullptr;
+    
+    // Address of the first operation
+    uint16_t counter = 0x0000;
+    
+    // Page offsets of the first and the last decoded byte
+    uint8_t first = 0x00;
+    uint8_t last  = 0x00;
+    
+    // Sum of base cycles
+    uint64_t cycles = 0;
+    
+    std::vector<Decoded> operations;
+    
+    // Jump target and fall through successors
+    mutable Link links[2];
+    
+    // Idle block changing state is downgraded to None
+    mutable Spin spin = Spin::None;
+    
+#ifdef JIT
+    mutable Native native = nullptr;
+    
+    // Runs counted until block is translated
+    mutable uint16_t runs = 0;
+#endif
+    
+#ifdef PROFILE
+    // Whole passes not yet added to profiler and cycles
+    // the last operation took above its base cycles
+    mutable uint64_t passes = 0;
+    mutable uint64_t extra  = 0;
+#endif
+};
+
+// Decoded blocks keyed by program counter
+class BlockCache
+{
+    // Host code checks stores against decoded bytes
+    friend class Jit;
+    
+public:
+    
+    struct Statistics
+    {
+        uint64_t hits              = 0; // Blocks found in cache
+        uint64_t linked            = 0; // Hits through block links
+        uint64_t misses            = 0; // Blocks decoded
+        uint64_t invalidations     = 0; // Stores to decoded bytes
+        uint64_t dropped           = 0; // Blocks dropped by stores
+        uint64_t skipped           = 0; // Loop passes not executed
+        uint64_t skippedOperations = 0; // Operations of skipped passes
+        uint64_t skippedCycles     = 0; // Cycles of skipped passes
+    };
+    
+private:
+    
+    // Operations per block
+    static const std::size_t limit = 32;
+    
+    // Page table of connected bus, follows Cpu::connect
+    const Pages * const & pages;
+    
+    // Host handlers of processor, blocks end before them
+    const std::unique_ptr<Traps> & traps;
+    
+    // Blocks by page and offset, allocated on demand
+    std::vector<std::unique_ptr<Block>> directory[256];
+    
+    // Bytes covered by decoded blocks, bit per byte
+    uint64_t code[256][4] {};
+    
+    // Incremented when code of page is modified
+    uint32_t generations[256] {};
+    
+    Statistics counters;
+    
+    // Dropped blocks live until next fetch, running
+    // or previous block may be among them
+    std::vector<std::unique_ptr<Block>> graveyard;
+    
+    // Fuse operation pairs of decoded blocks
+    const bool fusion;
+    
+    // Classify blocks looping onto themselves
+    const bool loops;
+    
+#ifdef PROFILE
+    // Receives whole passes of blocks, see Cpu::loop
+    Profiler & profiler;
+    
+    // Add passes of block to profiler
+    void account(const Block & block);
+#endif
+    
+    std::unique_ptr<Block> decode(uint16_t counter, const uint8_t * host) const;
+    
+    // Mark pairs executed by fused handlers
+    static void fuse(Block & block);
+    static Fusion fusable(uint8_t first, uint8_t second);
+    
+    // Mark bytes of block as code
+    void cover(uint8_t page, const Block & block);
+    
+    // Decode block missing in cache
+    const Block * miss(uint16_t counter);
+    
+    // Drop blocks containing written byte
+    void invalidate(uint16_t address);
+    
+    // Drop every block of page
+    void drop(uint8_t page);
+    
+    static bool terminates(uint8_t opcode);
+    
+    // Kind of loop formed by block
+    static Spin spins(const Block & block);
+    
+public:
+    
+    // Running block was dropped and must not continue
+    bool stale = false;
+    
+    template <class Processor>
+    BlockCache(const Processor & cpu, bool fusion, bool loops);
+    
+    // Block starting at counter or nullptr when
+    // operation has to be interpreted
+    const Block * fetch(uint16_t counter);
+    
+    // Successor of block, which has been run to the end
+    const Block * follow(const Block * block, uint16_t counter);
+    
+    // Called on every memory write
+    void written(uint16_t address);
+    
+    // Drop all blocks, e.g. after host changed memory
+    void clear();
+    
+    // Number of code modifications in page
+    uint32_t generation(uint8_t page) const;
+    
+    // Count passes of loop skipped by processor
+    void skip(const Block & block, uint64_t passes);
+    
+#ifdef PROFILE
+    // Add passes of every block to profiler
+    void account();
+#endif
+    
+    const Statistics & statistics() const;
+};
+
+// Cache follows page table and traps of processor
+template <class Processor>
+BlockCache::BlockCache(const Processor & cpu, bool fusion, bool loops) : pages(cpu.pages), traps(cpu.traps), fusion(fusion), loops(loops)
+#ifdef PROFILE
+    , profiler(*cpu.profiler)
+#endif
+{
+    
+}
+
+// Cached block is checked against page storage,
+// page may be switched to another bank since decoding
+inline const Block * BlockCache::fetch(uint16_t counter)
+{
+    if (stale || !graveyard.empty())
+    {
+#ifdef PROFILE
+        for (auto & block : graveyard) {
+            account(*block);
+        }
+#endif
+        
+        graveyard.clear();
+        stale = false;
+    }
+    
+    auto & page = directory[counter >> 8];
+    
+    if (!page.empty())
+    {
+        auto block = page[counter & 0xFF].get();
+        
+        if (block != nullptr && block -> host == pages -> read[counter >> 8] && block -> cycles > 0)
+        {
+            counters.hits++;
+            return block;
+        }
+    }
+    
+    return miss(counter);
+}
+
+// Link skips directory lookup. Pointer is used only
+// if page was not modified since linking, block
+// may be released otherwise
+inline const Block * BlockCache::follow(const Block * block, uint16_t counter)
+{
+    auto & link = block -> links[counter == block -> operations.back().next];
+    auto successor = link.block;
+    
+    if (successor != nullptr && link.generation == generations[counter >> 8])
+    {
+        if (successor -> counter == counter && successor -> host == pages -> read[counter >> 8])
+        {
+            counters.hits++;
+            counters.linked++;
+            
+            return successor;
+        }
+    }
+    
+    successor = fetch(counter);
+    
+    link.block = successor;
+    link.generation = generations[counter >> 8];
+    
+    return successor;
+}
+
+// Only stores to decoded bytes drop blocks,
+// data sharing page with code is written for free
+inline void BlockCache::written(uint16_t address)
+{
+    auto bits = code[address >> 8][(address & 0xFF) >> 6];
+    
+    if ((bits >> (address & 0x3F)) & 1) {
+        invalidate(address);
+    }
+}
+
+#endif /* BLOCKCACHE_HPP */
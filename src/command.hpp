@@ -18,21 +18,41 @@
 #ifndef COMMAND_HPP
 #define COMMAND_HPP
 
-#include <string>
+#include <cstdint>
 
-struct Command
+template <class Processor>
+struct BasicCommand
 {
     // Operation name
-    std::string name;
+    const char * name = nullptr;
     
     // Operation cycles
     uint8_t cycles = 0x00;
 
-    uint8_t (Cpu::*operate) (void) = nullptr;
-    void    (Cpu::*addrmod) (void) = nullptr;
+    uint8_t (Processor::*operate) (void) = nullptr;
+    void    (Processor::*addrmod) (void) = nullptr;
     
-    bool isImplied();
-    bool isIndirect();
+    bool isImplied()   const;
+    bool isIndirect()  const;
+    bool isImmediate() const;
 };
 
+template <class Processor>
+bool BasicCommand<Processor>::isImplied() const
+{
+    return addrmod == &Processor::IMP;
+}
+
+template <class Processor>
+bool BasicCommand<Processor>::isIndirect() const
+{
+    return addrmod == &Processor::DIR;
+}
+
+template <class Processor>
+bool BasicCommand<Processor>::isImmediate() const
+{
+    return addrmod == &Processor::IMM;
+}
+
 #endif /* Command_h */
@@ -0,0 +1,149 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "console.hpp"
+
+#pragma mark -
+#pragma mark Stream sink
+
+StreamSink::StreamSink(std::ostream & stream) : stream(stream)
+{
+    
+}
+
+void StreamSink::write(const char * data, std::size_t size)
+{
+    stream.write(data, (std::streamsize) size);
+}
+
+void StreamSink::flush()
+{
+    stream.flush();
+}
+
+#pragma mark -
+#pragma mark Console
+
+Console::Console(std::shared_ptr<Sink> sink, uint8_t port, std::size_t capacity, bool background) :
+    sink(std::move(sink)), port(port), capacity(std::max<std::size_t>(capacity, 1))
+{
+    buffer.reserve(this -> capacity);
+    
+    if (background)
+    {
+        pending.reserve(this -> capacity);
+        worker = std::thread(&Console::work, this);
+    }
+}
+
+uint8_t Console::read(uint8_t) const
+{
+    return 0x00;
+}
+
+void Console::write(uint8_t port, uint8_t data)
+{
+    if (port == this -> port) {
+        put(data);
+    }
+}
+
+void Console::put(uint8_t data)
+{
+    buffer.push_back((char) data);
+    
+    if (buffer.size() >= capacity) {
+        drain();
+    }
+}
+
+void Console::drain()
+{
+    if (buffer.empty()) {
+        return;
+    }
+    
+    if (!worker.joinable())
+    {
+        sink -> write(buffer.data(), buffer.size());
+        buffer.clear();
+        
+        return;
+    }
+    
+    // Previous buffer must be written before it is reused
+    std::unique_lock<std::mutex> lock(mutex);
+    ready.wait(lock, [this] { return pending.empty(); });
+    
+    std::swap(buffer, pending);
+    
+    lock.unlock();
+    wake.notify_one();
+}
+
+void Console::work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    
+    while (true)
+    {
+        wake.wait(lock, [this] { return stopped || !pending.empty(); });
+        
+        if (pending.empty()) {
+            return;
+        }
+        
+        // Guest thread does not touch pending until it is empty
+        lock.unlock();
+        sink -> write(pending.data(), pending.size());
+        lock.lock();
+        
+        pending.clear();
+        ready.notify_all();
+    }
+}
+
+void Console::flush()
+{
+    drain();
+    
+    if (worker.joinable())
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [this] { return pending.empty(); });
+    }
+    
+    sink -> flush();
+}
+
+Console::~Console()
+{
+    flush();
+    
+    if (worker.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+        }
+        
+        wake.notify_one();
+        worker.join();
+    }
+}
@@ -0,0 +1,109 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONSOLE_HPP
+#define CONSOLE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+#include "IO.hpp"
+
+// Destination of console output
+class Sink
+{
+public:
+    virtual void write(const char * data, std::size_t size) = 0;
+    virtual void flush() { };
+    
+    virtual ~Sink() = default;
+};
+
+// Sink writing into host stream
+class StreamSink final : public Sink
+{
+private:
+    std::ostream & stream;
+    
+public:
+    StreamSink(std::ostream & stream);
+    
+    virtual void write(const char * data, std::size_t size) override;
+    virtual void flush() override;
+};
+
+// Guest console on output port. Characters are collected
+// in buffer and passed to sink only when buffer is full,
+// on flush() or on destruction. With background thread
+// full buffer is written while guest keeps running
+class Console : public IO<uint8_t>
+{
+private:
+    std::shared_ptr<Sink> sink;
+    
+    // Port receiving characters
+    uint8_t port;
+    
+    // Filled by guest
+    std::vector<char> buffer;
+    
+    // Written by background thread
+    std::vector<char> pending;
+    
+    std::size_t capacity;
+    
+    std::thread worker;
+    std::mutex mutex;
+    
+    // Pending buffer became empty
+    std::condition_variable ready;
+    
+    // Pending buffer filled or stop requested
+    std::condition_variable wake;
+    
+    bool stopped = false;
+    
+    // Pass buffer to sink or background thread
+    void drain();
+    
+    void work();
+    
+public:
+    Console(std::shared_ptr<Sink> sink, uint8_t port = 0x01, std::size_t capacity = 64 * 1024, bool background = false);
+    
+    Console(const Console &) = delete;
+    Console & operator= (const Console &) = delete;
+    
+    virtual uint8_t read(uint8_t port) const override;
+    virtual void write(uint8_t port, uint8_t data) override;
+    
+    // Character printed by host, e.g. by trap handler
+    void put(uint8_t data);
+    
+    // Write everything printed so far and flush sink
+    void flush();
+    
+    virtual ~Console();
+};
+
+#endif /* CONSOLE_HPP */
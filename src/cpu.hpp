@@ -19,42 +19,32 @@
 #define CPU_HPP
 
 #include <cstdint>
-#include <vector>
-#include <functional>
 #include <memory>
 
 #include "asmlog.hpp"
+#include "blockcache.hpp"
 #include "command.hpp"
+#include "cpufwd.hpp"
+#include "jit.hpp"
+#include "profiler.hpp"
+#include "scheduler.hpp"
 #include "status.hpp"
+#include "trace.hpp"
+#include "trap.hpp"
+#include "memory.hpp"
 #include "IO.hpp"
 
-class Cpu
+// Bus and Ports are IO<uint16_t> and IO<uint8_t> or classes
+// derived from them. Calls to final classes are not virtual
+template <class Bus, class Ports, class Policy>
+class BasicCpu
 {
 public:
-    Cpu();
+    BasicCpu() = default;
     
-private:
-    
-    uint8_t  registers[8] {};    // Registers
-    uint8_t * regpairs[3] {};    // Pairs
-    
-    uint8_t  opcode  = 0x00;     // Operation code
-    uint8_t  cycles  = 0x00;     // Cycle counter
-
-    uint16_t stack   = 0x0000;   // Stack pointer
-    uint16_t counter = 0x0000;   // Program counter
-    
-    uint16_t address = 0x0000;   // Current memory pointer
-    uint64_t ticks   = 0x0L;     // Clock counter
-    
-    Status status;               // Status register
-    
-    // Intel 8080 operation list
-    std::vector<Command> commands;
-    
-    // Disassembler
-    friend void Asmlog::log(uint16_t counter, const Cpu * cpu);
-    friend struct Command;
+    using Command   = BasicCommand<BasicCpu>;
+    using Scheduler = BasicScheduler<BasicCpu>;
+    using Trap      = BasicTrap<BasicCpu>;
     
     enum Registers
     {
@@ -73,13 +63,93 @@ private:
         BC, //  0x00 - B & C
         DE, //  0x01 - D & E
         HL, //  0x02 - H & L
+        PSW //  0x03 - A & Status
     };
     
+private:
+    
+    // Registers in operation code order. Pairs BC, DE and HL
+    // are adjacent bytes, high register first
+    uint8_t  registers[8] {};
+    
+    uint8_t  opcode  = 0x00;     // Operation code
+    uint8_t  cycles  = 0x00;     // Cycle counter
+
+    uint16_t stack   = 0x0000;   // Stack pointer
+    uint16_t counter = 0x0000;   // Program counter
+    
+    uint16_t address = 0x0000;   // Current memory pointer
+    uint64_t ticks   = 0x0L;     // Clock counter
+    uint64_t retired = 0x0L;     // Executed instructions
+    
+    BasicStatus<Policy> status;  // Status register
+    
+    bool inte    = false;        // Interrupt enable flip-flop
+    bool halted  = false;        // Waiting for interrupt after HLT
+    
+    // Interrupt request waiting for acknowledge
+    bool    requested = false;
+    uint8_t request   = 0x00;    // RST operation put on data bus
+    
+    // Intel 8080 operation list
+    // Shared by all instances, built at compile time
+    static const Command commands[256];
+    
+    // Disassembler
+    friend class Asmlog;
+    friend class Trace;
+    friend struct BasicCommand<BasicCpu>;
+    friend class BlockCache;
+    friend class Profiler;
+    friend class Jit;
+    friend class CpuBatch;
+    
     // Memory bus
-    std::shared_ptr<IO<uint16_t>> bus = std::make_shared<DefaultIO<uint16_t>>();
+    std::shared_ptr<Bus> bus = Unconnected<Bus>::instance();
+    
+    // Direct access to bus pages, see Memory
+    const Pages * pages = &nopages;
+    
+    // Page table of bus without direct access
+    static const Pages nopages;
+    
+    // Decoded blocks, nullptr when disabled
+    std::unique_ptr<BlockCache> cache;
+    
+#ifdef JIT
+    // Host code of hot blocks, exists with cache
+    std::unique_ptr<Jit> jit;
+#endif
+    
+    // Host handlers, nullptr when none is added
+    std::unique_ptr<Traps> traps;
+    
+    BasicTraps<BasicCpu> & handlers() const;
+    
+    // Device events by clock
+    Scheduler scheduler;
     
     // Device communication
-    std::shared_ptr<IO<uint8_t>> io = std::make_shared<DefaultIO<uint8_t>>();
+    std::shared_ptr<Ports> io = Unconnected<Ports>::instance();
+    
+#ifdef ASMLOG
+    // Last executed operations
+    std::unique_ptr<Trace> trace = std::make_unique<Trace>();
+#endif
+    
+#ifdef PROFILE
+    std::unique_ptr<Profiler> profiler = std::make_unique<Profiler>();
+    
+    // Operations of whole block pass are recorded by block,
+    // see BlockCache::account
+    bool counted = false;
+    
+    // Count operation executed at counter with stack pointer before
+    void profile(uint16_t counter, uint16_t stack, uint8_t cycles);
+    
+    // Calls and returns of whole block pass
+    void profile(const Decoded & last, uint64_t extra);
+#endif
     
 private:
     
@@ -93,8 +163,63 @@ private:
     // Return registry pair value
     uint16_t readpair (uint8_t index) const;
     
-    void writepair  (uint8_t index, uint16_t data);
-    void mutatepair (uint8_t index, std::function<void(uint16_t &)> mutator);
+    void writepair (uint8_t index, uint16_t data);
+    
+    // Execute single operation and return spent cycles,
+    // start is clock before operation shown by trace
+    uint8_t execute(uint64_t start);
+    uint8_t execute(const Decoded & operation, uint64_t start);
+    uint8_t execute(const Decoded & first, const Decoded & second, uint64_t start);
+    
+    // Return from trapped subroutine and call its handler
+    uint8_t invoke();
+    
+    // Request can be accepted before the next operation.
+    // Operation following EI is executed before interrupt
+    bool interruptible() const;
+    
+    // Execute requested RST operation
+    uint8_t acknowledge();
+    
+    // Condition of Jcc, Ccc and Rcc operation
+    bool condition(uint8_t opcode) const;
+    
+    // Execute operations until any limit is reached,
+    // executed operations are subtracted from remaining
+    uint64_t loop(uint64_t cycles, uint64_t & remaining);
+    
+    // Limit of loop lowered to the next event
+    uint64_t deadline(uint64_t start, uint64_t cycles);
+    
+    // Spend cycles remaining from the last clock()
+    uint64_t drain(uint64_t limit);
+    
+    // State compared between passes of idle loop
+    struct Snapshot
+    {
+        uint8_t  registers[8];
+        uint16_t stack;
+        uint8_t  status;
+        
+        bool operator== (const Snapshot & other) const;
+    };
+    
+    Snapshot capture() const;
+    
+    // Loop blocks, see Spin. Skipped passes are charged
+    // to clock without executing operations
+    uint64_t fit(const Block & block, uint64_t passes, uint64_t cycles, uint64_t instructions) const;
+    uint64_t skip(const Block & block, uint64_t passes, uint64_t & instructions);
+    uint64_t countdown(const Block & block, uint64_t cycles, uint64_t & instructions);
+    bool stable(const Block & block) const;
+    
+#ifdef SWITCH_DISPATCH
+    // Set address mode and execute operation
+    uint8_t dispatch();
+    
+    // Execute operation with address already set
+    uint8_t operate();
+#endif
     
 // Communication
 private:
@@ -285,16 +410,78 @@ public:
     
     void clock();
     void reset();
+    
+    // Both stop at every scheduled event and fire it, also
+    // at events scheduled by devices and traps meanwhile.
+    // Halted processor is moved to the next event
+    uint64_t run  (uint64_t cycles);
+    uint64_t step (unsigned instructions = 1);
+    
+    // Execute decoded blocks in run() and step(),
+    // optionally with fused operation pairs and
+    // skipped passes of busy-wait loops
+    void enableCache (bool fusion = true, bool loops = true);
+    void disableCache();
 
     void setCounter(uint16_t counter);
     
-    void connect (std::shared_ptr<IO<uint16_t>> bus);
-    void connect (std::shared_ptr<IO<uint8_t>>  io);
+    // Concrete Bus and Ports have to be connected before run
+    void connect (std::shared_ptr<Bus>   bus);
+    void connect (std::shared_ptr<Ports> io);
     
     uint16_t getCounter();
     uint64_t getClock  ();
     
-    virtual ~Cpu() = default;
+    // Instructions executed, acknowledged interrupts and
+    // skipped passes of busy-wait loops included
+    uint64_t getInstructions() const;
+    
+    // Request interrupt with RST operation. Request is held
+    // until interrupts are enabled, it is accepted between
+    // decoded blocks when cache is enabled
+    void interrupt(uint8_t operation = 0xFF);
+    
+    bool isHalted() const;
+    bool isInterruptEnabled() const;
+    
+    // Events of devices due at absolute getClock()
+    Scheduler & getScheduler();
+    
+    // Call host handler instead of subroutine at address.
+    // Operation is not executed, handler is followed by RET
+    void addTrap   (uint16_t address, std::shared_ptr<Trap> trap);
+    void removeTrap(uint16_t address);
+    
+    // State access for host handlers
+    uint8_t  getRegister(Registers index) const;
+    uint16_t getPair    (Pairs index) const;
+    uint16_t getStack   () const;
+    uint8_t  getMemory  (uint16_t address) const;
+    
+    void setRegister(Registers index, uint8_t data);
+    void setPair    (Pairs index, uint16_t data);
+    void setStack   (uint16_t stack);
+    void setMemory  (uint16_t address, uint8_t data);
+    
+    // Zero when cache is disabled
+    BlockCache::Statistics getCacheStatistics();
+    
+#ifdef JIT
+    Jit::Statistics getJitStatistics();
+#endif
+    
+#ifdef ASMLOG
+    Trace & getTrace();
+#endif
+    
+#ifdef PROFILE
+    Profiler & getProfiler();
+#endif
+    
+    virtual ~BasicCpu() = default;
 };
 
+// Instantiated once in the library, see cpu.tpp
+extern template class BasicCpu<IO<uint16_t>, IO<uint8_t>>;
+
 #endif /* CPU_HPP */
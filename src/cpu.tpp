@@ -0,0 +1,3599 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Definitions of BasicCpu, included by translation units
+// instantiating processor with their own Bus and Ports
+
+#ifndef CPU_TPP
+#define CPU_TPP
+
+#include <algorithm>
+#include <type_traits>
+
+#include "cpu.hpp"
+
+template <class Bus, class Ports, class Policy>
+const Pages BasicCpu<Bus, Ports, Policy>::nopages {};
+
+template <class Bus, class Ports, class Policy>
+constexpr BasicCommand<BasicCpu<Bus, Ports, Policy>> BasicCpu<Bus, Ports, Policy>::commands[256] =
+{
+    // 0x00 - 0x0F
+    
+    { "NOP",     4,        &BasicCpu::NOP,      &BasicCpu::IMP },
+    { "LXI",     10,       &BasicCpu::LXI,      &BasicCpu::DIR },
+    { "STAX",    7,        &BasicCpu::STAX,     &BasicCpu::IMP },
+    { "INX",     5,        &BasicCpu::INX,      &BasicCpu::IMP },
+    { "INR",     5,        &BasicCpu::INRR,     &BasicCpu::IMP },
+    { "DCR",     5,        &BasicCpu::DCRR,     &BasicCpu::IMP },
+    { "MVI",     7,        &BasicCpu::MVIR,     &BasicCpu::IMM },
+    { "RLC",     4,        &BasicCpu::RLC,      &BasicCpu::IMP },
+    { "NOP",     4,        &BasicCpu::NOP,      &BasicCpu::IMP },
+    { "DAD",     10,       &BasicCpu::DAD,      &BasicCpu::IMP },
+    { "LDAX",    7,        &BasicCpu::LDAX,     &BasicCpu::IND },
+    { "DCX",     5,        &BasicCpu::DCX,      &BasicCpu::IMP },
+    { "INR",     5,        &BasicCpu::INRR,     &BasicCpu::IMP },
+    { "DCR",     5,        &BasicCpu::DCRR,     &BasicCpu::IMP },
+    { "MVI",     7,        &BasicCpu::MVIR,     &BasicCpu::IMM },
+    { "RRC",     4,        &BasicCpu::RRC,      &BasicCpu::IMP },
+    
+    // 0x01 - 0x0F
+    
+    { "NOP",     4,        &BasicCpu::NOP,      &BasicCpu::IMP },
+    { "LXI",     10,       &BasicCpu::LXI,      &BasicCpu::DIR },
+    { "STAX",    7,        &BasicCpu::STAX,     &BasicCpu::IMP },
+    { "INX",     5,        &BasicCpu::INX,      &BasicCpu::IMP },
+    { "INR",     5,        &BasicCpu::INRR,     &BasicCpu::IMP },
+    { "DCR",     5,        &BasicCpu::DCRR,     &BasicCpu::IMP },
+    { "MVI",     7,        &BasicCpu::MVIR,     &BasicCpu::IMM },
+    { "RAL",     4,        &BasicCpu::RAL,      &BasicCpu::IMP },
+    { "NOP",     4,        &BasicCpu::NOP,      &BasicCpu::IMP },
+    { "DAD",     10,       &BasicCpu::DAD,      &BasicCpu::IMP },
+    { "LDAX",    7,        &BasicCpu::LDAX,     &BasicCpu::IND },
+    { "DCX",     5,        &BasicCpu::DCX,      &BasicCpu::IMP },
+    { "INR",     5,        &BasicCpu::INRR,     &BasicCpu::IMP },
+    { "DCR",     5,        &BasicCpu::DCRR,     &BasicCpu::IMP },
+    { "MVI",     7,        &BasicCpu::MVIR,     &BasicCpu::IMM },
+    { "RAR",     4,        &BasicCpu::RAR,      &BasicCpu::IMP },
+    
+    // 0x02 - 0x0F
+    
+    { "NOP",     4,        &BasicCpu::NOP,      &BasicCpu::IMP },
+    { "LXI",     10,       &BasicCpu::LXI,      &BasicCpu::DIR },
+    { "SHLD",    16,       &BasicCpu::SHLD,     &BasicCpu::DIR },
+    { "INX",     5,        &BasicCpu::INX,      &BasicCpu::IMP },
+    { "INR",     5,        &BasicCpu::INRR,     &BasicCpu::IMP },
+    { "DCR",     5,        &BasicCpu::DCRR,     &BasicCpu::IMP },
+    { "MVI",     7,        &BasicCpu::MVIR,     &BasicCpu::IMM },
+    { "DAA",     4,        &BasicCpu::DAA,      &BasicCpu::IMP },
+    { "NOP",     4,        &BasicCpu::NOP,      &BasicCpu::IMP },
+    { "DAD",     10,       &BasicCpu::DAD,      &BasicCpu::IMP },
+    { "LHLD",    16,       &BasicCpu::LHLD,     &BasicCpu::DIR },
+    { "DCX",     5,        &BasicCpu::DCX,      &BasicCpu::IMP },
+    { "INR",     5,        &BasicCpu::INRR,     &BasicCpu::IMP },
+    { "DCR",     5,        &BasicCpu::DCRR,     &BasicCpu::IMP },
+    { "MVI",     7,        &BasicCpu::MVIR,     &BasicCpu::IMM },
+    { "CMA",     4,        &BasicCpu::CMA,      &BasicCpu::IMP },
+    
+    // 0x03 - 0x0F
+    
+    { "NOP",     4,        &BasicCpu::NOP,      &BasicCpu::IMP },
+    { "LXI",     10,       &BasicCpu::LXISP,    &BasicCpu::DIR },
+    { "STA",     13,       &BasicCpu::STA,      &BasicCpu::DIR },
+    { "INX",     5,        &BasicCpu::INXSP,    &BasicCpu::IMP },
+    { "INR",     10,       &BasicCpu::INRM,     &BasicCpu::HLM },
+    { "DCR",     10,       &BasicCpu::DCRM,     &BasicCpu::HLM },
+    { "MVI",     10,       &BasicCpu::MVIM,     &BasicCpu::IMM },
+    { "STC",     4,        &BasicCpu::STC,      &BasicCpu::IMP },
+    { "NOP",     4,        &BasicCpu::NOP,      &BasicCpu::IMP },
+    { "DAD",     10,       &BasicCpu::DADSP,    &BasicCpu::IMP },
+    { "LDA",     13,       &BasicCpu::LDA,      &BasicCpu::DIR },
+    { "DCX",     5,        &BasicCpu::DCXSP,    &BasicCpu::IMP },
+    { "INR",     5,        &BasicCpu::INRR,     &BasicCpu::IMP },
+    { "DCR",     5,        &BasicCpu::DCRR,     &BasicCpu::IMP },
+    { "MVI",     7,        &BasicCpu::MVIR,     &BasicCpu::IMM },
+    { "CMC",     4,        &BasicCpu::CMC,      &BasicCpu::IMP },
+    
+    
+    // 0x04 - 0x0F
+    
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     7,        &BasicCpu::MOVRM,    &BasicCpu::HLM },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     7,        &BasicCpu::MOVRM,    &BasicCpu::HLM },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    
+    // 0x05 - 0x0F
+    
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     7,        &BasicCpu::MOVRM,    &BasicCpu::HLM },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     7,        &BasicCpu::MOVRM,    &BasicCpu::HLM },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    
+    // 0x06 - 0x0F
+    
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     7,        &BasicCpu::MOVRM,    &BasicCpu::HLM },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     7,        &BasicCpu::MOVRM,    &BasicCpu::HLM },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    
+    // 0x07 - 0x0F
+    
+    { "MOV",     7,        &BasicCpu::MOVMR,    &BasicCpu::HLM },
+    { "MOV",     7,        &BasicCpu::MOVMR,    &BasicCpu::HLM },
+    { "MOV",     7,        &BasicCpu::MOVMR,    &BasicCpu::HLM },
+    { "MOV",     7,        &BasicCpu::MOVMR,    &BasicCpu::HLM },
+    { "MOV",     7,        &BasicCpu::MOVMR,    &BasicCpu::HLM },
+    { "MOV",     7,        &BasicCpu::MOVMR,    &BasicCpu::HLM },
+    { "HLT",     4,        &BasicCpu::HLT,      &BasicCpu::IMP },
+    { "MOV",     7,        &BasicCpu::MOVMR,    &BasicCpu::HLM },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    { "MOV",     7,        &BasicCpu::MOVRM,    &BasicCpu::HLM },
+    { "MOV",     5,        &BasicCpu::MOVRR,    &BasicCpu::IMP },
+    
+    // 0x08 - 0x0F
+    
+    { "ADD",     4,        &BasicCpu::ADDR,     &BasicCpu::IMP },
+    { "ADD",     4,        &BasicCpu::ADDR,     &BasicCpu::IMP },
+    { "ADD",     4,        &BasicCpu::ADDR,     &BasicCpu::IMP },
+    { "ADD",     4,        &BasicCpu::ADDR,     &BasicCpu::IMP },
+    { "ADD",     4,        &BasicCpu::ADDR,     &BasicCpu::IMP },
+    { "ADD",     4,        &BasicCpu::ADDR,     &BasicCpu::IMP },
+    { "ADD",     7,        &BasicCpu::ADDM,     &BasicCpu::HLM },
+    { "ADD",     4,        &BasicCpu::ADDR,     &BasicCpu::IMP },
+    { "ADC",     4,        &BasicCpu::ADCR,     &BasicCpu::IMP },
+    { "ADC",     4,        &BasicCpu::ADCR,     &BasicCpu::IMP },
+    { "ADC",     4,        &BasicCpu::ADCR,     &BasicCpu::IMP },
+    { "ADC",     4,        &BasicCpu::ADCR,     &BasicCpu::IMP },
+    { "ADC",     4,        &BasicCpu::ADCR,     &BasicCpu::IMP },
+    { "ADC",     4,        &BasicCpu::ADCR,     &BasicCpu::IMP },
+    { "ADC",     7,        &BasicCpu::ADCM,     &BasicCpu::HLM },
+    { "ADC",     4,        &BasicCpu::ADCR,     &BasicCpu::IMP },
+    
+    // 0x09 - 0x0F
+    
+    { "SUB",     4,        &BasicCpu::SUBR,     &BasicCpu::IMP },
+    { "SUB",     4,        &BasicCpu::SUBR,     &BasicCpu::IMP },
+    { "SUB",     4,        &BasicCpu::SUBR,     &BasicCpu::IMP },
+    { "SUB",     4,        &BasicCpu::SUBR,     &BasicCpu::IMP },
+    { "SUB",     4,        &BasicCpu::SUBR,     &BasicCpu::IMP },
+    { "SUB",     4,        &BasicCpu::SUBR,     &BasicCpu::IMP },
+    { "SUB",     7,        &BasicCpu::SUBM,     &BasicCpu::HLM },
+    { "SUB",     4,        &BasicCpu::SUBR,     &BasicCpu::IMP },
+    { "SBB",     4,        &BasicCpu::SBBR,     &BasicCpu::IMP },
+    { "SBB",     4,        &BasicCpu::SBBR,     &BasicCpu::IMP },
+    { "SBB",     4,        &BasicCpu::SBBR,     &BasicCpu::IMP },
+    { "SBB",     4,        &BasicCpu::SBBR,     &BasicCpu::IMP },
+    { "SBB",     4,        &BasicCpu::SBBR,     &BasicCpu::IMP },
+    { "SBB",     4,        &BasicCpu::SBBR,     &BasicCpu::IMP },
+    { "SBB",     7,        &BasicCpu::SBBM,     &BasicCpu::HLM },
+    { "SBB",     4,        &BasicCpu::SBBR,     &BasicCpu::IMP },
+    
+    // 0x0A - 0x0F
+    
+    { "ANA",     4,        &BasicCpu::ANAR,     &BasicCpu::IMP },
+    { "ANA",     4,        &BasicCpu::ANAR,     &BasicCpu::IMP },
+    { "ANA",     4,        &BasicCpu::ANAR,     &BasicCpu::IMP },
+    { "ANA",     4,        &BasicCpu::ANAR,     &BasicCpu::IMP },
+    { "ANA",     4,        &BasicCpu::ANAR,     &BasicCpu::IMP },
+    { "ANA",     4,        &BasicCpu::ANAR,     &BasicCpu::IMP },
+    { "ANA",     7,        &BasicCpu::ANAM,     &BasicCpu::HLM },
+    { "ANA",     4,        &BasicCpu::ANAR,     &BasicCpu::IMP },
+    { "XRA",     4,        &BasicCpu::XRAR,     &BasicCpu::IMP },
+    { "XRA",     4,        &BasicCpu::XRAR,     &BasicCpu::IMP },
+    { "XRA",     4,        &BasicCpu::XRAR,     &BasicCpu::IMP },
+    { "XRA",     4,        &BasicCpu::XRAR,     &BasicCpu::IMP },
+    { "XRA",     4,        &BasicCpu::XRAR,     &BasicCpu::IMP },
+    { "XRA",     4,        &BasicCpu::XRAR,     &BasicCpu::IMP },
+    { "XRA",     7,        &BasicCpu::XRAM,     &BasicCpu::HLM },
+    { "XRA",     4,        &BasicCpu::XRAR,     &BasicCpu::IMP },
+    
+    // 0x0B - 0x0F
+    
+    { "ORA",     4,        &BasicCpu::ORAR,     &BasicCpu::IMP },
+    { "ORA",     4,        &BasicCpu::ORAR,     &BasicCpu::IMP },
+    { "ORA",     4,        &BasicCpu::ORAR,     &BasicCpu::IMP },
+    { "ORA",     4,        &BasicCpu::ORAR,     &BasicCpu::IMP },
+    { "ORA",     4,        &BasicCpu::ORAR,     &BasicCpu::IMP },
+    { "ORA",     4,        &BasicCpu::ORAR,     &BasicCpu::IMP },
+    { "ORA",     7,        &BasicCpu::ORAM,     &BasicCpu::HLM },
+    { "ORA",     4,        &BasicCpu::ORAR,     &BasicCpu::IMP },
+    { "CMP",     4,        &BasicCpu::CMPR,     &BasicCpu::IMP },
+    { "CMP",     4,        &BasicCpu::CMPR,     &BasicCpu::IMP },
+    { "CMP",     4,        &BasicCpu::CMPR,     &BasicCpu::IMP },
+    { "CMP",     4,        &BasicCpu::CMPR,     &BasicCpu::IMP },
+    { "CMP",     4,        &BasicCpu::CMPR,     &BasicCpu::IMP },
+    { "CMP",     4,        &BasicCpu::CMPR,     &BasicCpu::IMP },
+    { "CMP",     7,        &BasicCpu::CMPM,     &BasicCpu::HLM },
+    { "CMP",     4,        &BasicCpu::CMPR,     &BasicCpu::IMP },
+    
+    // 0x0C - 0x0F
+    
+    { "RNZ",     5,        &BasicCpu::RNZ,      &BasicCpu::IMP },
+    { "POP",    10,        &BasicCpu::POPR,     &BasicCpu::IMP },
+    { "JNZ",    10,        &BasicCpu::JNZ,      &BasicCpu::DIR },
+    { "JMP",    10,        &BasicCpu::JMP,      &BasicCpu::DIR },
+    { "CNZ",    11,        &BasicCpu::CNZ,      &BasicCpu::DIR },
+    { "PUSH",   11,        &BasicCpu::PUSHR,    &BasicCpu::IMP },
+    { "ADI",     7,        &BasicCpu::ADI,      &BasicCpu::IMM },
+    { "RST",    11,        &BasicCpu::RST,      &BasicCpu::IMP },
+    { "RZ",      5,        &BasicCpu::RZ,       &BasicCpu::IMP },
+    { "RET",    10,        &BasicCpu::RET,      &BasicCpu::IMP },
+    { "JZ",     10,        &BasicCpu::JZ,       &BasicCpu::DIR },
+    { "JMP",    10,        &BasicCpu::JMP,      &BasicCpu::DIR },
+    { "CZ",     11,        &BasicCpu::CZ,       &BasicCpu::DIR },
+    { "CALL",   17,        &BasicCpu::CALL,     &BasicCpu::DIR },
+    { "ACI",     7,        &BasicCpu::ACI,      &BasicCpu::IMM },
+    { "RST",    11,        &BasicCpu::RST,      &BasicCpu::IMP },
+    
+    // 0x0D - 0x0F
+    
+    { "RNC",     5,        &BasicCpu::RNC,      &BasicCpu::IMP },
+    { "POP",    10,        &BasicCpu::POPR,     &BasicCpu::IMP },
+    { "JNC",    10,        &BasicCpu::JNC,      &BasicCpu::DIR },
+    { "OUT",    10,        &BasicCpu::OUT,      &BasicCpu::IMM },
+    { "CNC",    11,        &BasicCpu::CNC,      &BasicCpu::DIR },
+    { "PUSH",   11,        &BasicCpu::PUSHR,    &BasicCpu::IMP },
+    { "SUI",     7,        &BasicCpu::SUI,      &BasicCpu::IMM },
+    { "RST",    11,        &BasicCpu::RST,      &BasicCpu::IMP },
+    { "RC",      5,        &BasicCpu::RC,       &BasicCpu::IMP },
+    { "RET",    10,        &BasicCpu::RET,      &BasicCpu::IMP },
+    { "JC",     10,        &BasicCpu::JC,       &BasicCpu::DIR },
+    { "IN",     10,        &BasicCpu::IN,       &BasicCpu::IMM },
+    { "CC",     11,        &BasicCpu::CC,       &BasicCpu::DIR },
+    { "CALL",   17,        &BasicCpu::CALL,     &BasicCpu::DIR },
+    { "SBI",     7,        &BasicCpu::SBI,      &BasicCpu::IMM },
+    { "RST",    11,        &BasicCpu::RST,      &BasicCpu::IMP },
+    
+    // 0x0E - 0x0F
+    
+    { "RPO",     5,        &BasicCpu::RPO,      &BasicCpu::IMP },
+    { "POP",    10,        &BasicCpu::POPR,     &BasicCpu::IMP },
+    { "JPO",    10,        &BasicCpu::JPO,      &BasicCpu::DIR },
+    { "XTHL",   18,        &BasicCpu::XTHL,     &BasicCpu::IMP },
+    { "CPO",    11,        &BasicCpu::CPO,      &BasicCpu::DIR },
+    { "PUSH",   11,        &BasicCpu::PUSHR,    &BasicCpu::IMP },
+    { "ANI",     7,        &BasicCpu::ANI,      &BasicCpu::IMM },
+    { "RST",    11,        &BasicCpu::RST,      &BasicCpu::IMP },
+    { "RPE",     5,        &BasicCpu::RPE,      &BasicCpu::IMP },
+    { "PCHL",    5,        &BasicCpu::PCHL,     &BasicCpu::IMP },
+    { "JPE",    10,        &BasicCpu::JPE,      &BasicCpu::DIR },
+    { "XCHG",    4,        &BasicCpu::XCHG,     &BasicCpu::IMP },
+    { "CPE",    11,        &BasicCpu::CPE,      &BasicCpu::DIR },
+    { "CALL",   17,        &BasicCpu::CALL,     &BasicCpu::DIR },
+    { "XDI",     7,        &BasicCpu::XRI,      &BasicCpu::IMM },
+    { "RST",    11,        &BasicCpu::RST,      &BasicCpu::IMP },
+    
+    // 0x0F - 0x0F
+    
+    { "RP",      5,        &BasicCpu::RP,       &BasicCpu::IMP },
+    { "POP",    10,        &BasicCpu::POP,      &BasicCpu::IMP },
+    { "JP",     10,        &BasicCpu::JP,       &BasicCpu::DIR },
+    { "DI",      4,        &BasicCpu::DI,       &BasicCpu::IMP },
+    { "CP",     11,        &BasicCpu::CP,       &BasicCpu::DIR },
+    { "PUSH",   11,        &BasicCpu::PUSH,     &BasicCpu::IMP },
+    { "ORI",     7,        &BasicCpu::ORI,      &BasicCpu::IMM },
+    { "RST",    11,        &BasicCpu::RST,      &BasicCpu::IMP },
+    { "RM",      5,        &BasicCpu::RM,       &BasicCpu::IMP },
+    { "SPHL",    5,        &BasicCpu::SPHL,     &BasicCpu::IMP },
+    { "JM",     10,        &BasicCpu::JM,       &BasicCpu::DIR },
+    { "EI",      4,        &BasicCpu::EI,       &BasicCpu::IMP },
+    { "CM",     11,        &BasicCpu::CM,       &BasicCpu::DIR },
+    { "CALL",   17,        &BasicCpu::CALL,     &BasicCpu::DIR },
+    { "CPI",     7,        &BasicCpu::CPI,      &BasicCpu::IMM },
+    { "RST",    11,        &BasicCpu::RST,      &BasicCpu::IMP }
+};
+
+template <class Bus, class Ports, class Policy>
+inline bool BasicCpu<Bus, Ports, Policy>::interruptible() const
+{
+    return requested && inte && opcode != 0xFB;
+}
+
+// Cycles from start to the earliest of limit and event
+template <class Bus, class Ports, class Policy>
+uint64_t BasicCpu<Bus, Ports, Policy>::deadline(uint64_t start, uint64_t cycles)
+{
+    uint64_t next = scheduler.limit();
+    
+    if (next == UINT64_MAX) {
+        return cycles;
+    }
+    
+    return std::min(cycles, next > start ? next - start : 0);
+}
+
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::clock()
+{
+    ticks++;
+    
+    scheduler.dispatch(*this, ticks);
+
+    if (cycles > 0)
+    {
+        cycles--;
+        return;
+    }
+    
+    if (interruptible())
+    {
+        cycles = acknowledge() - 1;
+        retired++;
+        return;
+    }
+    
+    // Halted processor idles until interrupt
+    if (halted) {
+        return;
+    }
+    
+    // Operation is executed on the first tick,
+    // the rest are idle until cycles run out
+    cycles = execute(ticks - 1) - 1;
+    retired++;
+}
+
+// Loop stops at events, including ones scheduled while it runs
+template <class Bus, class Ports, class Policy>
+uint64_t BasicCpu<Bus, Ports, Policy>::run(uint64_t cycles)
+{
+    uint64_t spent = drain(cycles);
+    uint64_t instructions = UINT64_MAX;
+    
+    scheduler.dispatch(*this, ticks);
+    
+    while (spent < cycles)
+    {
+        spent += loop(cycles - spent, instructions);
+        scheduler.dispatch(*this, ticks);
+    }
+    
+    retired += UINT64_MAX - instructions;
+    
+    return spent;
+}
+
+template <class Bus, class Ports, class Policy>
+uint64_t BasicCpu<Bus, Ports, Policy>::step(unsigned instructions)
+{
+    uint64_t spent = drain(this -> cycles);
+    uint64_t remaining = instructions;
+    
+    scheduler.dispatch(*this, ticks);
+    
+    while (remaining > 0)
+    {
+        spent += loop(UINT64_MAX, remaining);
+        scheduler.dispatch(*this, ticks);
+        
+        // Halted processor waits for one event at most
+        if (halted && !interruptible()) {
+            break;
+        }
+    }
+    
+    retired += instructions - remaining;
+    
+    return spent;
+}
+
+template <class Bus, class Ports, class Policy>
+uint64_t BasicCpu<Bus, Ports, Policy>::loop(uint64_t cycles, uint64_t & remaining)
+{
+    uint64_t spent = 0;
+    uint64_t instructions = remaining;
+    uint64_t start = ticks;
+    
+    // Previous block completely executed
+    const Block * block = nullptr;
+    
+    cycles = deadline(start, cycles);
+    
+    while (spent < cycles && instructions > 0)
+    {
+        // Devices and traps may schedule events before
+        // the limit, the loop stops at them as well
+        if (scheduler.hastened())
+        {
+            cycles = deadline(start, cycles);
+            continue;
+        }
+        
+        if (requested || halted)
+        {
+            if (interruptible())
+            {
+                uint8_t taken = acknowledge();
+                
+                spent += taken;
+                ticks += taken;
+                
+                instructions--;
+                
+                block = nullptr;
+                continue;
+            }
+            
+            // Operation following EI runs alone, so the
+            // interrupt is accepted right after it
+            if (inte && opcode == 0xFB)
+            {
+                uint8_t taken = execute(ticks);
+                
+                spent += taken;
+                ticks += taken;
+                
+                instructions--;
+                
+                block = nullptr;
+                continue;
+            }
+            
+            // Skip to the limit, i.e. the next event or the end
+            // of run(). Halted processor has nothing to step()
+            if (halted)
+            {
+                if (cycles != UINT64_MAX)
+                {
+                    ticks += cycles - spent;
+                    spent  = cycles;
+                }
+                
+                break;
+            }
+        }
+        
+        // Block is entered again right after its own pass
+        const Block * previous = block;
+        
+        if (cache != nullptr)
+        {
+            // Trapped address is left to execute()
+            if (traps != nullptr && traps -> contains(counter)) {
+                block = nullptr;
+            }
+            else {
+                block = block ? cache -> follow(block, counter) : cache -> fetch(counter);
+            }
+        }
+        
+        if (block == nullptr)
+        {
+            uint8_t taken = execute(ticks);
+            
+            spent += taken;
+            ticks += taken;
+            
+            instructions--;
+            continue;
+        }
+        
+        // State before pass of idle loop
+        Snapshot snapshot;
+        bool idle = false;
+        
+        switch (block -> spin)
+        {
+            case Spin::None:
+                break;
+                
+            case Spin::Idle:
+                idle = stable(*block);
+                
+                if (idle) {
+                    snapshot = capture();
+                }
+                else {
+                    block -> spin = Spin::None;
+                }
+                break;
+                
+            default:
+                spent += countdown(*block, cycles - spent, instructions);
+                break;
+        }
+        
+        uint64_t before = spent;
+        uint64_t executed = 0;
+        
+        // Limits can't be reached before the last operation
+        bool whole = spent + block -> cycles < cycles
+                  && block -> operations.size() <= instructions;
+        
+        auto & operations = block -> operations;
+        std::size_t index = 0;
+        
+#ifdef PROFILE
+        // Block may be dropped during the pass
+        // but lives until the next fetch
+        const Block * current = block;
+        counted = whole;
+#endif
+        
+#ifdef JIT
+        // Host code runs leading operations of whole block,
+        // interpreter continues where it stopped
+        if (jit != nullptr && whole)
+        {
+            if (block -> native == nullptr) {
+                jit -> heat(*block);
+            }
+            
+            if (block -> native != nullptr)
+            {
+                uint32_t done = block -> native(this);
+                
+                index    = done & 0xFF;
+                executed = index;
+                spent   += done >> 8;
+            }
+        }
+#endif
+        
+        for (; index < operations.size(); index++)
+        {
+            auto & operation = operations[index];
+            
+            // Fused pair can't be split by limits
+            if (whole && operation.fusion != Fusion::None)
+            {
+                spent += execute(operation, operations[++index], ticks + spent - before);
+                executed += 2;
+            }
+            else
+            {
+                spent += execute(operation, ticks + spent - before);
+                executed++;
+            }
+            
+            // Block was modified by the operation
+            if (cache -> stale)
+            {
+                block = nullptr;
+                break;
+            }
+            
+            // Stop inside block at the same operation
+            // as interpreter would do
+            if (!whole && (spent >= cycles || executed == instructions)) {
+                break;
+            }
+            
+            // Event scheduled by the operation
+            if (scheduler.hastened())
+            {
+                block = nullptr;
+                break;
+            }
+        }
+        
+        ticks += spent - before;
+        instructions -= executed;
+        
+#ifdef PROFILE
+        // Pass cut short is recorded by operation,
+        // it never reaches a call or return
+        if (counted)
+        {
+            if (executed == operations.size())
+            {
+                uint64_t extra = spent - before - current -> cycles;
+                
+                current -> passes++;
+                current -> extra += extra;
+                
+                profile(operations.back(), extra);
+            }
+            else
+            {
+                for (std::size_t i = 0; i < executed; i++) {
+                    profiler -> record(operations[i].counter, operations[i].opcode, operations[i].cycles);
+                }
+            }
+            
+            counted = false;
+        }
+#endif
+        
+        // Pass of idle loop is repeated until limit. The first pass
+        // may change state left by code before the loop, so only
+        // the following one is expected to change nothing
+        if (idle && block != nullptr && counter == block -> counter && executed == operations.size() && spent < cycles)
+        {
+            if (capture() == snapshot) {
+                spent += skip(*block, fit(*block, UINT64_MAX, cycles - spent, instructions), instructions);
+            }
+            else if (previous == block) {
+                block -> spin = Spin::None;
+            }
+        }
+    }
+    
+    remaining = instructions;
+    return spent;
+}
+
+// Passes ending before both limits
+template <class Bus, class Ports, class Policy>
+uint64_t BasicCpu<Bus, Ports, Policy>::fit(const Block & block, uint64_t passes, uint64_t cycles, uint64_t instructions) const
+{
+    if (cycles == 0 || instructions == 0) {
+        return 0;
+    }
+    
+    passes = std::min(passes, (cycles - 1) / block.cycles);
+    passes = std::min(passes, (instructions - 1) / block.operations.size());
+    
+    return passes;
+}
+
+template <class Bus, class Ports, class Policy>
+uint64_t BasicCpu<Bus, Ports, Policy>::skip(const Block & block, uint64_t passes, uint64_t & instructions)
+{
+    uint64_t taken = passes * block.cycles;
+    
+    ticks += taken;
+    instructions -= passes * block.operations.size();
+    
+    cache -> skip(block, passes);
+    
+    return taken;
+}
+
+// Counter is moved to one pass before zero, the last pass
+// is executed to leave flags and accumulator as they would be
+template <class Bus, class Ports, class Policy>
+uint64_t BasicCpu<Bus, Ports, Policy>::countdown(const Block & block, uint64_t cycles, uint64_t & instructions)
+{
+    uint8_t opcode = block.operations.front().opcode;
+    
+    bool pair = block.spin == Spin::Pair;
+    bool down = opcode & (pair ? 0x08 : 0x01);
+    
+    uint8_t index = pair ? (opcode >> 4) & 0x03 : (opcode >> 3) & 0x07;
+    
+    uint32_t modulo = pair ? 0x10000 : 0x100;
+    uint32_t value  = pair ? readpair(index) : registers[index];
+    
+    // Passes until counter becomes zero
+    uint32_t count = (down ? value : modulo - value) % modulo;
+    
+    if (count == 0) {
+        count = modulo;
+    }
+    
+    uint64_t passes = fit(block, count - 1, cycles, instructions);
+    
+    value = down ? value - (uint32_t) passes : value + (uint32_t) passes;
+    
+    if (pair) {
+        writepair(index, (uint16_t) value);
+    }
+    else {
+        registers[index] = (uint8_t) value;
+    }
+    
+    return skip(block, passes, instructions);
+}
+
+// Inputs of idle loop don't change until the next event
+template <class Bus, class Ports, class Policy>
+bool BasicCpu<Bus, Ports, Policy>::stable(const Block & block) const
+{
+    for (auto & operation : block.operations)
+    {
+        uint8_t  code = operation.opcode;
+        uint16_t address;
+        
+        if (code == 0xDB)                                  // IN
+        {
+            if (!io -> stable(read(operation.address))) {
+                return false;
+            }
+            continue;
+        }
+        
+        if (code == 0x3A || code == 0x2A) {                // LDA, LHLD
+            address = operation.address;
+        }
+        else if (code == 0x0A || code == 0x1A) {           // LDAX
+            address = readpair(code >> 4);
+        }
+        else if ((code & 0xC7) == 0x46 || (code >= 0x80 && code < 0xC0 && (code & 0x07) == 0x06)) {
+            address = readpair(HL);                        // MOV r, M and ALU M
+        }
+        else {
+            continue;
+        }
+        
+        // Memory mapped IO may change any time
+        if (pages -> read[address >> 8] == nullptr || pages -> read[(uint16_t) (address + 1) >> 8] == nullptr) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+template <class Bus, class Ports, class Policy>
+typename BasicCpu<Bus, Ports, Policy>::Snapshot BasicCpu<Bus, Ports, Policy>::capture() const
+{
+    Snapshot snapshot;
+    
+    std::copy(registers, registers + 8, snapshot.registers);
+    
+    snapshot.stack  = stack;
+    snapshot.status = status;
+    
+    return snapshot;
+}
+
+template <class Bus, class Ports, class Policy>
+bool BasicCpu<Bus, Ports, Policy>::Snapshot::operator== (const Snapshot & other) const
+{
+    return std::equal(registers, registers + 8, other.registers)
+        && stack  == other.stack
+        && status == other.status;
+}
+
+// Consume cycles left by operation started in clock()
+template <class Bus, class Ports, class Policy>
+uint64_t BasicCpu<Bus, Ports, Policy>::drain(uint64_t limit)
+{
+    uint8_t taken = cycles < limit ? cycles : (uint8_t) limit;
+    
+    cycles -= taken;
+    ticks  += taken;
+    
+    return taken;
+}
+
+#ifdef PROFILE
+// Taken calls and returns are recognized by stack pointer
+// moved by two bytes, operation code is looked at only then
+template <class Bus, class Ports, class Policy>
+inline void BasicCpu<Bus, Ports, Policy>::profile(uint16_t counter, uint16_t stack, uint8_t cycles)
+{
+    if (counted) {
+        return;
+    }
+    
+    profiler -> record(counter, opcode, cycles);
+    
+    if (stack == this -> stack) {
+        return;
+    }
+    
+    if ((uint16_t) (stack - 2) == this -> stack)
+    {
+        if (opcode == 0xCD || (opcode & 0xC7) == 0xC4 || (opcode & 0xC7) == 0xC7
+                           || opcode == 0xDD || opcode == 0xED || opcode == 0xFD) {
+            profiler -> call(counter, this -> counter);
+        }
+    }
+    else if ((uint16_t) (stack + 2) == this -> stack)
+    {
+        if (opcode == 0xC9 || opcode == 0xD9 || (opcode & 0xC7) == 0xC0) {
+            profiler -> ret(counter, this -> counter);
+        }
+    }
+}
+
+// Whole pass of block, only its last operation may call or
+// return. Conditional ones are taken when they add cycles
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::profile(const Decoded & last, uint64_t extra)
+{
+    uint8_t opcode = last.opcode;
+    
+    if (opcode == 0xCD || (opcode & 0xC7) == 0xC7 || opcode == 0xDD || opcode == 0xED || opcode == 0xFD
+                       || ((opcode & 0xC7) == 0xC4 && extra > 0)) {
+        profiler -> call(last.counter, counter);
+    }
+    else if (opcode == 0xC9 || opcode == 0xD9 || ((opcode & 0xC7) == 0xC0 && extra > 0)) {
+        profiler -> ret(last.counter, counter);
+    }
+}
+#endif
+
+template <class Bus, class Ports, class Policy>
+inline uint8_t BasicCpu<Bus, Ports, Policy>::execute(uint64_t start)
+{
+    // Host handler instead of operation
+    if (traps != nullptr && traps -> contains(counter)) {
+        return invoke();
+    }
+    
+#if defined(ASMLOG) || defined(PROFILE)
+    uint16_t pcl = counter;
+#endif
+    
+#ifdef PROFILE
+    uint16_t sp = stack;
+#endif
+    
+    // Read operation code
+    opcode = read(counter);
+    
+    // Increment program counter
+    counter++;
+    
+#ifdef SWITCH_DISPATCH
+    // Execute operation with inlined address mode
+    uint8_t taken = commands[opcode].cycles + dispatch();
+#else
+    // Set address mode
+    (this->*commands[opcode].addrmod)();
+    
+    // Execute operation and add extra cycles
+    uint8_t taken = commands[opcode].cycles + (this->*commands[opcode].operate)();
+#endif
+    
+#ifdef ASMLOG
+    trace -> record(pcl, start, *this);
+#else
+    (void) start;
+#endif
+    
+#ifdef PROFILE
+    profile(pcl, sp, taken);
+#endif
+    
+    return taken;
+}
+
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::execute(const Decoded & operation, uint64_t start)
+{
+#ifdef PROFILE
+    uint16_t sp = stack;
+#endif
+    
+    opcode  = operation.opcode;
+    counter = operation.next;
+    address = operation.address;
+    
+#ifdef SWITCH_DISPATCH
+    uint8_t taken = operation.cycles + operate();
+#else
+    if (!operation.resolved) {
+        (this->*commands[opcode].addrmod)();
+    }
+    
+    uint8_t taken = operation.cycles + (this->*commands[opcode].operate)();
+#endif
+    
+#ifdef ASMLOG
+    trace -> record(operation.counter, start, *this);
+#else
+    (void) start;
+#endif
+    
+#ifdef PROFILE
+    profile(operation.counter, sp, taken);
+#endif
+    
+    return taken;
+}
+
+// Fused handlers skip dispatching of the second operation
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::execute(const Decoded & first, const Decoded & second, uint64_t start)
+{
+    uint8_t taken = second.cycles;
+    
+    if (first.fusion == Fusion::Increment)
+    {
+        opcode = first.opcode;
+        
+        HLM();
+        MOVRM();
+        
+        writepair(HL, readpair(HL) + 1);
+        
+        taken += first.cycles;
+        
+#ifdef PROFILE
+        profile(first.counter, stack, first.cycles);
+#endif
+    }
+    else
+    {
+        taken += execute(first, start);
+    }
+    
+#ifdef PROFILE
+    uint16_t sp = stack;
+#endif
+    
+    opcode  = second.opcode;
+    counter = second.next;
+    address = second.address;
+    
+    switch (first.fusion)
+    {
+        case Fusion::Branch:
+            if (condition(opcode)) {
+                counter = address;
+            }
+            break;
+            
+        case Fusion::Call:
+            CALL();
+            break;
+            
+        default:
+            break;
+    }
+    
+#ifdef PROFILE
+    profile(second.counter, sp, second.cycles);
+#endif
+    
+    return taken;
+}
+
+// Interrupt disables further interrupts
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::acknowledge()
+{
+    inte      = false;
+    halted    = false;
+    requested = false;
+    
+    opcode = request;
+    RST();
+    
+    return commands[opcode].cycles;
+}
+
+// Trap costs as much as RET
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::invoke()
+{
+    auto trap = handlers().find(counter);
+    
+    opcode = 0xC9;
+    RET();
+    
+    trap -> call(*this);
+    
+    return commands[opcode].cycles;
+}
+
+template <class Bus, class Ports, class Policy>
+bool BasicCpu<Bus, Ports, Policy>::condition(uint8_t opcode) const
+{
+    switch ((opcode >> 3) & 0x07)
+    {
+        case 0x00: return !status.GetZero();   // NZ
+        case 0x01: return  status.GetZero();   // Z
+        case 0x02: return !status.GetCarry();  // NC
+        case 0x03: return  status.GetCarry();  // C
+        case 0x04: return !status.GetParity(); // PO
+        case 0x05: return  status.GetParity(); // PE
+        case 0x06: return !status.GetSign();   // P
+    }
+    
+    return status.GetSign(); // M
+}
+
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::reset()
+{
+    writepair(BC, 0x0000);
+    writepair(DE, 0x0000);
+    writepair(HL, 0x0000);
+    
+    registers[A] = 0x00;
+    
+    stack   = 0x00;
+    counter = 0x00;
+    address = 0x00;
+    
+    cycles  = 0x00;
+    opcode  = 0x00;
+    ticks   = 0x00;
+    retired = 0x00;
+    
+    // Events are due at clock of previous run
+    scheduler.clear();
+    
+    inte      = false;
+    halted    = false;
+    requested = false;
+    
+    status.SetAllFlags(0x0000);
+}
+
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::enableCache(bool fusion, bool loops)
+{
+#ifdef PROFILE
+    if (cache != nullptr) {
+        cache -> account();
+    }
+#endif
+    
+    cache = std::make_unique<BlockCache>(*this, fusion, loops);
+    
+#if defined(JIT) && !defined(ASMLOG) && !defined(PROFILE)
+    // Host code doesn't record operations
+    // and computes status eagerly
+    if (std::is_same<Policy, Eager>::value) {
+        jit = std::make_unique<Jit>(*this, *cache);
+    }
+#endif
+}
+
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::disableCache()
+{
+#ifdef JIT
+    jit = nullptr;
+#endif
+    
+#ifdef PROFILE
+    if (cache != nullptr) {
+        cache -> account();
+    }
+#endif
+    
+    cache = nullptr;
+}
+
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::setCounter(uint16_t counter)
+{
+    this -> counter = counter;
+}
+
+template <class Bus, class Ports, class Policy>
+uint16_t BasicCpu<Bus, Ports, Policy>::getCounter()
+{
+    return this -> counter;
+}
+
+template <class Bus, class Ports, class Policy>
+uint64_t BasicCpu<Bus, Ports, Policy>::getClock ()
+{
+    return ticks;
+}
+
+template <class Bus, class Ports, class Policy>
+uint64_t BasicCpu<Bus, Ports, Policy>::getInstructions() const
+{
+    return retired;
+}
+
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::interrupt(uint8_t operation)
+{
+    request   = operation;
+    requested = true;
+}
+
+template <class Bus, class Ports, class Policy>
+bool BasicCpu<Bus, Ports, Policy>::isHalted() const
+{
+    return halted;
+}
+
+template <class Bus, class Ports, class Policy>
+bool BasicCpu<Bus, Ports, Policy>::isInterruptEnabled() const
+{
+    return inte;
+}
+
+template <class Bus, class Ports, class Policy>
+typename BasicCpu<Bus, Ports, Policy>::Scheduler & BasicCpu<Bus, Ports, Policy>::getScheduler()
+{
+    return scheduler;
+}
+
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::addTrap(uint16_t address, std::shared_ptr<Trap> trap)
+{
+    if (traps == nullptr) {
+        traps = std::make_unique<BasicTraps<BasicCpu>>();
+    }
+    
+    handlers().add(address, std::move(trap));
+    
+    // Decoded blocks may run over trapped address
+    if (cache != nullptr) {
+        cache -> clear();
+    }
+}
+
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::removeTrap(uint16_t address)
+{
+    if (traps == nullptr) {
+        return;
+    }
+    
+    handlers().remove(address);
+    
+    if (handlers().empty()) {
+        traps = nullptr;
+    }
+}
+
+// Traps are created by addTrap() only
+template <class Bus, class Ports, class Policy>
+BasicTraps<BasicCpu<Bus, Ports, Policy>> & BasicCpu<Bus, Ports, Policy>::handlers() const
+{
+    return (BasicTraps<BasicCpu> &) *traps;
+}
+
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::getRegister(Registers index) const
+{
+    return registers[index];
+}
+
+template <class Bus, class Ports, class Policy>
+uint16_t BasicCpu<Bus, Ports, Policy>::getPair(Pairs index) const
+{
+    if (index == PSW) {
+        return registers[A] << 8 | status;
+    }
+    
+    return readpair(index);
+}
+
+template <class Bus, class Ports, class Policy>
+uint16_t BasicCpu<Bus, Ports, Policy>::getStack() const
+{
+    return stack;
+}
+
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::getMemory(uint16_t address) const
+{
+    return read(address);
+}
+
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::setRegister(Registers index, uint8_t data)
+{
+    registers[index] = data;
+}
+
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::setPair(Pairs index, uint16_t data)
+{
+    if (index == PSW)
+    {
+        registers[A] = data >> 8;
+        status = data & 0xFF;
+        
+        return;
+    }
+    
+    writepair(index, data);
+}
+
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::setStack(uint16_t stack)
+{
+    this -> stack = stack;
+}
+
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::setMemory(uint16_t address, uint8_t data)
+{
+    write(address, data);
+}
+
+#ifdef ASMLOG
+template <class Bus, class Ports, class Policy>
+Trace & BasicCpu<Bus, Ports, Policy>::getTrace()
+{
+    return *trace;
+}
+#endif
+
+#ifdef PROFILE
+template <class Bus, class Ports, class Policy>
+Profiler & BasicCpu<Bus, Ports, Policy>::getProfiler()
+{
+    // Passes of cached blocks are added on demand
+    if (cache != nullptr) {
+        cache -> account();
+    }
+    
+    return *profiler;
+}
+#endif
+
+template <class Bus, class Ports, class Policy>
+BlockCache::Statistics BasicCpu<Bus, Ports, Policy>::getCacheStatistics()
+{
+    if (cache == nullptr) {
+        return BlockCache::Statistics();
+    }
+    
+    return cache -> statistics();
+}
+
+#ifdef JIT
+template <class Bus, class Ports, class Policy>
+Jit::Statistics BasicCpu<Bus, Ports, Policy>::getJitStatistics()
+{
+    if (jit == nullptr) {
+        return Jit::Statistics();
+    }
+    
+    return jit -> statistics();
+}
+#endif
+
+#pragma mark -
+#pragma mark Pairs
+
+// Read source register
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::readsrc()
+{
+    return registers[opcode & 0x07];
+}
+
+// Read destination register
+template <class Bus, class Ports, class Policy>
+uint8_t & BasicCpu<Bus, Ports, Policy>::readdst()
+{
+    return registers[(opcode & 0x38) >> 3];
+}
+
+// Read registry pair as uint16_t. Compilers merge
+// both bytes into a single load with byte swap
+template <class Bus, class Ports, class Policy>
+uint16_t BasicCpu<Bus, Ports, Policy>::readpair(uint8_t index) const
+{
+    uint16_t hi = registers[index * 2 + 0];
+    uint16_t lo = registers[index * 2 + 1];
+
+    return (uint16_t) (hi << 8) | lo;
+}
+
+// Write uint16_t to registry pair
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::writepair(uint8_t index, uint16_t data)
+{
+    registers[index * 2 + 0] = (data >> 8) & 0xFF;
+    registers[index * 2 + 1] = data & 0xFF;
+}
+
+#pragma mark -
+#pragma mark Bus communications
+
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::read() const
+{
+    return read(address);
+}
+
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::read(uint16_t address) const
+{
+    auto page = pages -> read[address >> 8];
+    
+    if (page != nullptr) {
+        return page[address & 0xFF];
+    }
+    
+    return bus -> read(address);
+}
+
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::write(uint8_t data)
+{
+    write(address, data);
+}
+
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::write(uint16_t address, uint8_t data)
+{
+    auto page = pages -> write[address >> 8];
+    
+    if (page != nullptr)
+    {
+        // ROM and unmapped pages write elsewhere,
+        // only stores to read storage modify code
+        if (cache != nullptr && page == pages -> read[address >> 8]) {
+            cache -> written(address);
+        }
+        
+        page[address & 0xFF] = data;
+        return;
+    }
+    
+    bus -> write(address, data);
+}
+
+#pragma mark -
+#pragma mark Connect
+
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::connect(std::shared_ptr<Bus> bus)
+{
+    this -> bus = bus;
+    
+    // Use host pointers when bus provides them
+    auto memory = dynamic_cast<const Memory *>(bus.get());
+    this -> pages = memory ? &memory -> pages() : &nopages;
+}
+
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::connect(std::shared_ptr<Ports> io)
+{
+    this -> io = io;
+}
+
+#pragma mark -
+#pragma mark Addressing modes
+
+// No set address pointer
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::IMP()
+{
+    address = 0x00;
+}
+
+// Set address pointer to accumulator
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::IND()
+{
+    address = registers[A];
+}
+
+// Set address pointer to A16
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::DIR()
+{
+    uint16_t lo = read(counter++);
+    uint16_t hi = read(counter++);
+    
+    address = (uint16_t) (hi << 8) | lo;
+}
+
+// Set address pointer to D8
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::IMM()
+{
+    address = counter++;
+}
+
+// Set address pointer to H & L registry pair
+template <class Bus, class Ports, class Policy>
+void BasicCpu<Bus, Ports, Policy>::HLM()
+{
+    address = readpair(HL);
+}
+
+#pragma mark -
+#pragma mark Move, Load, Store
+
+// Code: MOV r1, r2
+// Operation: (r2) → r1
+// Description: Move register to register
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::MOVRR()
+{
+    readdst() = readsrc();
+    return 0;
+}
+
+// Code: MOV M, r
+// Operation: (r) → [(HL)]
+// Description: Move register to memory
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::MOVMR()
+{
+    auto value = readsrc();
+    write(value);
+    
+    return 0;
+}
+
+// Code: MOV r, M
+// Operation: [(HL)] → r
+// Description: Move memory to register
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::MOVRM()
+{
+    readdst() = read();
+    return 0;
+}
+
+// Code: MVI r, D8
+// Operation: D8 → r
+// Description: Move immediate register
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::MVIR()
+{
+    return MOVRM();
+}
+
+// Code: MVI M, D8
+// Operation: D8 → [(HL)]
+// Description: Move immediate memory
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::MVIM()
+{
+    auto value = read();
+    write(readpair(HL), value);
+    
+    return 0;
+}
+
+// Code: LXI RP
+// Operation: D16 → RP
+// Description: Load immediate register pair B & C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::LXI()
+{
+    writepair((opcode & 0x30) >> 4, address);
+    return 0;
+}
+
+// Code: LXI SP
+// Operation: D16 → SP
+// Description: Load immediate SP
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::LXISP()
+{
+    stack = address;
+    return 0;
+}
+
+// Code: STAX B
+// Operation: (A) → [(RP)]
+// Description: Store A indent
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::STAX()
+{
+    auto pair = (opcode & 0x10) >> 4;
+    auto data = readpair(pair);
+
+    write(data, registers[A]);
+    
+    return 0;
+}
+
+// Code: LDAX D
+// Operation: [(RP)] → A
+// Description: Load A indirect
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::LDAX()
+{
+    auto pair = (opcode & 0x10) >> 4;
+    auto data = readpair(pair);
+    
+    registers[A] = read(data);
+    
+    return 0;
+}
+
+// Code: STA A16
+// Operation: (A) → [(A16)]
+// Description: Store A direct
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::STA()
+{
+    write(registers[A]);
+    return 0;
+}
+
+// Code: LDA A16
+// Operation: [(A16)] → A
+// Description: Load A direct
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::LDA()
+{
+    registers[A] = read();
+    return 0;
+}
+
+// Code: SHLD A16
+// Operation: (L) → [A16], (H) → [A16+1]
+// Description: Store H & L direct
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::SHLD()
+{
+    write(address + 0, registers[L]);
+    write(address + 1, registers[H]);
+    
+    return 0;
+}
+
+// Code: LHLD A16
+// Operation: [A16] → L, [A16+1] → H
+// Description: Load H & L direct
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::LHLD()
+{
+    registers[L] = read(address + 0);
+    registers[H] = read(address + 1);
+    
+    return 0;
+}
+
+// Code: XCHG
+// Operation: (HL) ↔ (DE)
+// Description: Echange D & E, H & L registers
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::XCHG()
+{
+    uint16_t data = readpair(DE);
+    
+    writepair(DE, readpair(HL));
+    writepair(HL, data);
+    
+    return 0;
+}
+
+#pragma mark -
+#pragma mark Stack operations
+
+// Code: PUSH
+// Operation: A → [(SP) - 1], (SR) → [(SP) - 2]
+// Description: Push program status word on stack
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::PUSH  (uint8_t hi, uint8_t lo)
+{
+    write(--stack, hi);
+    write(--stack, lo);
+    
+    return 0;
+}
+
+// Code: POP
+// Operation: [(SP)] → L, [(SP) + 1] → H
+// Description: Pop register pair off stack
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::POP   (uint8_t & hi, uint8_t & lo)
+{
+    lo = read(stack++);
+    hi = read(stack++);
+    
+    return 0;
+}
+
+// Code: PUSH rp
+// Operation: (RPH) → [(SP) - 1], (RPL) → [(SP)- 2]
+// Description: Push register pair on stack
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::PUSHR ()
+{
+    auto pair = (opcode & 0x30) >> 3;
+    
+    return PUSH(
+        registers[pair + 0],
+        registers[pair + 1]
+    );
+}
+
+// Code: PUSH PSW
+// Operation: A → [(SP) - 1], (SR) → [(SP) - 2]
+// Description: Push program status word on stack
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::PUSH  ()
+{
+    return PUSH(registers[A], status);
+}
+
+// Code: POP rp
+// Operation: [(SP)] → RPL, [(SP) + 1] → RPH
+// Description: Pop register pair off stack
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::POPR  ()
+{
+    auto pair = (opcode & 0x30) >> 3;
+    
+    return POP(
+       registers[pair + 0],
+       registers[pair + 1]
+   );
+}
+
+// Code: POP PSW
+// Operation: [(SP)] → A, [(SP) + 1] → SR
+// Description: Pop register pair off stack
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::POP   ()
+{
+    uint8_t status = this -> status;
+    uint8_t cycles = POP(registers[A], status);
+    
+    this -> status = status;
+    
+    return cycles;
+}
+
+// Code: XTHL
+// Operation: [(SP)] ↔ (L), [(SP) + 1] ↔ (H)
+// Description: Exchange top of stack, H & L
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::XTHL  ()
+{
+    uint8_t hi = 0x00;
+    uint8_t lo = 0x00;
+    
+    POP(hi, lo);
+    PUSH(registers[H], registers[L]);
+    
+    registers[H] = hi;
+    registers[L] = lo;
+    
+    return 0;
+}
+
+// Code: SPHL
+// Operation: (HL) → (SP)
+// Description: H & L to stack pointer
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::SPHL  ()
+{
+    stack = readpair(HL);
+    return 0;
+}
+
+#pragma mark -
+#pragma mark Jump
+
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::JMP (uint8_t flag)
+{
+    if (flag == 0)
+    {
+        return 0;
+    }
+    
+    return JMP();
+}
+
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::JMPN (uint8_t flag)
+{
+    return JMP(!flag);
+}
+
+// Code: JMP
+// Operation: [A16] → PC
+// Description: Jump unconditional
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::JMP  ()
+{
+    counter = address;
+    return 0;
+}
+
+// Code: JC
+// Operation: [A16] → PC
+// Description: Jump on carry
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::JC   ()
+{
+    auto flag = status.GetCarry();
+    return JMP(flag);
+}
+
+// Code: JNC
+// Operation: [A16] → PC
+// Description: Jump on no carry
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::JNC  ()
+{
+    auto flag = status.GetCarry();
+    return JMPN(flag);
+}
+
+// Code: JZ
+// Operation: [A16] → PC
+// Description: Jump on zero
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::JZ   ()
+{
+    auto flag = status.GetZero();
+    return JMP(flag);
+}
+
+// Code: JNZ
+// Operation: [A16] → PC
+// Description: Jump on no zero
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::JNZ  ()
+{
+    auto flag = status.GetZero();
+    return JMPN(flag);
+}
+
+// Code: JP
+// Operation: [A16] → PC
+// Description: Jump on positive
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::JP   ()
+{
+    auto flag = status.GetSign();
+    return JMPN(flag);
+}
+
+// Code: JM
+// Operation: [A16] → PC
+// Description: Jump on minus
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::JM   ()
+{
+    auto flag = status.GetSign();
+    return JMP(flag);
+}
+
+// Code: JPE
+// Operation: [A16] → PC
+// Description: Jump on parity even
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::JPE  ()
+{
+    auto flag = status.GetParity();
+    return JMP(flag);
+}
+
+// Code: JPO
+// Operation: [A16] → PC
+// Description: Jump on parity odd
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::JPO  ()
+{
+    auto flag = status.GetParity();
+    return JMPN(flag);
+}
+
+// Code: PCHL
+// Operation: (H) → PCH, (L) → PCL
+// Description: H & L to program counter
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::PCHL ()
+{
+    counter = readpair(HL);
+    return 0;
+}
+
+#pragma mark -
+#pragma mark Call
+
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::CALL (uint8_t flag)
+{
+    if (flag == 0)
+    {
+        return 0;
+    }
+    
+    CALL();
+    return 6;
+}
+
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::CALN (uint8_t flag)
+{
+    return CALL(!flag);
+}
+
+// Code: CALL 
+// Operation: (PCH) → [(SP)-1], (PCL) → [(SP)-2], A16 → PC
+// Description: Call unconditional
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::CALL ()
+{
+    PUSH((counter >> 8) & 0xFF, counter & 0xFF);
+    counter = address;
+    
+    return 0;
+}
+
+// Code: CC
+// Operation: (PCH) → [(SP)-1], (PCL) → [(SP)-2], A16 → PC
+// Description: Call on carry
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::CC   ()
+{
+    auto flag = status.GetCarry();
+    return CALL(flag);
+}
+
+// Code: CNC
+// Operation: (PCH) → [(SP)-1], (PCL) → [(SP)-2], A16 → PC
+// Description: Call on no carry
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::CNC  ()
+{
+    auto flag = status.GetCarry();
+    return CALN(flag);
+}
+
+// Code: CZ
+// Operation: (PCH) → [(SP)-1], (PCL) → [(SP)-2], A16 → PC
+// Description: Call on zero
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::CZ   ()
+{
+    auto flag = status.GetZero();
+    return CALL(flag);
+}
+
+// Code: CNZ
+// Operation: (PCH) → [(SP)-1], (PCL) → [(SP)-2], A16 → PC
+// Description: Call on no zero
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::CNZ  ()
+{
+    auto flag = status.GetZero();
+    return CALN(flag);
+}
+
+// Code: CP
+// Operation: (PCH) → [(SP)-1], (PCL) → [(SP)-2], A16 → PC
+// Description: Call on positive
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::CP   ()
+{
+    auto flag = status.GetSign();
+    return CALN(flag);
+}
+
+// Code: CM
+// Operation: (PCH) → [(SP)-1], (PCL) → [(SP)-2], A16 → PC
+// Description: Call on minus
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::CM   ()
+{
+    auto flag = status.GetSign();
+    return CALL(flag);
+}
+
+// Code: CPE
+// Operation: (PCH) → [(SP)-1], (PCL) → [(SP)-2], A16 → PC
+// Description: Call on parity even
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::CPE  ()
+{
+    auto flag = status.GetParity();
+    return CALL(flag);
+}
+
+// Code: CPO
+// Operation: (PCH) → [(SP)-1], (PCL) → [(SP)-2], A16 → PC
+// Description: Call on parity odd
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::CPO  ()
+{
+    auto flag = status.GetParity();
+    return CALN(flag);
+}
+
+#pragma mark -
+#pragma mark Return
+
+// Return if positive
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::RET (uint8_t flag)
+{
+    if (flag == 0)
+    {
+        return 0;
+    }
+    
+    RET();
+    return 6;
+}
+
+// Return if negative
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::RETN (uint8_t flag)
+{
+    return RET(!flag);
+}
+
+// Code: RET
+// Operation: [(SP)] → PCL, [(SP)+1] → PCH
+// Description: Return
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::RET  ()
+{
+    uint8_t lo = 0x00;
+    uint8_t hi = 0x00;
+    
+    POP(hi, lo);
+
+    counter = ((uint16_t) hi << 8) | lo;
+    
+    return 0;
+}
+
+// Code: RC
+// Operation: [(SP)] → PCL, [(SP)+1] → PCH
+// Description: Return if carry set
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::RC   ()
+{
+    auto flag = status.GetCarry();
+    return RET(flag);
+}
+
+// Code: RC
+// Operation: [(SP)] → PCL, [(SP)+1] → PCH
+// Description: Return if carry reset
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::RNC  ()
+{
+    auto flag = status.GetCarry();
+    return RETN(flag);
+}
+
+// Code: RZ
+// Operation: [(SP)] → PCL, [(SP)+1] → PCH
+// Description: Return if zero set
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::RZ   ()
+{
+    auto flag = status.GetZero();
+    return RET(flag);
+}
+
+// Code: RNZ
+// Operation: [(SP)] → PCL, [(SP)+1] → PCH
+// Description: Return if zero reset
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::RNZ  ()
+{
+    auto flag = status.GetZero();
+    return RETN(flag);
+}
+
+// Code: RM
+// Operation: [(SP)] → PCL, [(SP)+1] → PCH
+// Description: Return if minus
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::RM   ()
+{
+    auto flag = status.GetSign();
+    return RET(flag);
+}
+
+// Code: RP
+// Operation: [(SP)] → PCL, [(SP)+1] → PCH
+// Description: Return if plus
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::RP   ()
+{
+    auto flag = status.GetSign();
+    return RETN(flag);
+}
+
+// Code: RPE
+// Operation: [(SP)] → PCL, [(SP)+1] → PCH
+// Description: Return if parity even
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::RPE  ()
+{
+    auto flag = status.GetParity();
+    return RET(flag);
+}
+
+// Code: RPO
+// Operation: [(SP)] → PCL, [(SP)+1] → PCH
+// Description: Return if parity odd
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::RPO  ()
+{
+    auto flag = status.GetParity();
+    return RETN(flag);
+}
+
+#pragma mark -
+#pragma mark Restart
+
+// Code: RST
+// Operation: (PCH) → [(SP)-1], (PCL) → [(SP)-2], 0000 0000 00NN N000 → PC
+// Description: Restart
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::RST  ()
+{
+    auto hi = (counter >> 8) & 0xFF;
+    auto lo = counter & 0x00FF;
+    
+    PUSH(hi, lo);
+    
+    counter = (uint16_t) opcode & 0x38;
+    
+    return 0;
+}
+
+#pragma mark -
+#pragma mark Increment and decrement
+
+
+// Code: INR R
+// Operation: (r) + 1 → r
+// Description: Increment register
+// Flags: S,Z,AC,P
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::INR (uint16_t value)
+{
+    readdst() = ++value & 0x00FF;
+    status.SetIncrement(value & 0x00FF);
+    
+    return 0;
+}
+
+// Code: INR R
+// Operation: (r) + 1 → r
+// Description: Increment register
+// Flags: S,Z,AC,P
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::INRR ()
+{
+    uint16_t value = readdst();
+    return INR(value);
+}
+
+// Code: INR M
+// Operation: [(HL)] + 1 → [(HL)]
+// Description: Increment memory
+// Flags: S,Z,AC,P
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::INRM ()
+{
+    uint16_t value = read();
+    write(++value);
+    
+    status.SetIncrement(value & 0x00FF);
+    
+    return 0;
+}
+
+// Code: DCR r
+// Operation: (r) – 1 → r
+// Description: Decrement register
+// Flags: S,Z,AC,P
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::DCR (uint16_t value)
+{
+    readdst() = --value & 0x00FF;
+    status.SetDecrement(value & 0x00FF);
+    
+    return 0;
+}
+
+// Code: DCR r
+// Operation: (r) – 1 → r
+// Description: Decrement register
+// Flags: S,Z,AC,P
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::DCRR ()
+{
+    uint16_t value = readdst();
+    return DCR(value);
+}
+
+// Code: DCR M
+// Operation: [(HL)] - 1 → [(HL)]
+// Description: Decrement memory
+// Flags: S,Z,AC,P
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::DCRM ()
+{
+    uint16_t value = read();
+    write(--value);
+    
+    status.SetDecrement(value & 0x00FF);
+    
+    return 0;
+}
+
+// Code: INX RP
+// Operation: (RP) + 1 → r
+// Description: Increment registry pair
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::INX  ()
+{
+    auto pair = (opcode & 0x30) >> 4;
+    writepair(pair, readpair(pair) + 1);
+    
+    return 0;
+}
+
+// Code: INX SP
+// Operation: (RP) + 1 → r
+// Description: Increment registry pair
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::INXSP  ()
+{
+    stack++;
+    return 0;
+}
+
+// Code: DCX RP
+// Operation: (RP) - 1 → r
+// Description: Decrement registry pair
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::DCX  ()
+{
+    auto pair = (opcode & 0x30) >> 4;
+    writepair(pair, readpair(pair) - 1);
+    
+    return 0;
+}
+
+// Code: DCX SP
+// Operation: (RP) - 1 → r
+// Description: Decrement SP
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::DCXSP  ()
+{
+    stack--;
+    return 0;
+}
+
+#pragma mark -
+#pragma mark Add
+
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::ADD(uint8_t value, uint8_t carry)
+{
+    uint16_t acc = registers[A];
+    uint16_t tmp = acc + value + carry;
+    registers[A] = tmp & 0x00FF;
+    
+    // Carries out of bits 3 and 7
+    status.SetArithmetic(tmp, tmp ^ acc ^ value);
+    
+    return 0;
+}
+
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::ADC(uint8_t data)
+{
+    auto carry = status.GetCarry();
+    return ADD (data, carry);
+}
+
+// Code: ADD r
+// Operation: (A) + (r) → A
+// Description: Add register to A
+// Flags: S,Z,AC,P,C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::ADDR ()
+{
+    auto value = readsrc();
+    return ADD(value);
+}
+
+// Code: ADD M
+// Operation: (A) + М → A
+// Description: Add memory to A
+// Flags: S,Z,AC,P,C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::ADDM ()
+{
+    auto value = read();
+    return ADD(value);
+}
+
+// Code: ADC r
+// Operation: (A) + (r) + C → A
+// Description: Add register to A with carry
+// Flags: S,Z,AC,P,C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::ADCR ()
+{
+    auto value = readsrc();
+    return ADC(value);
+}
+
+// Code: ADC M
+// Operation: (A) + М + С → A
+// Description: Add memory to A with carry
+// Flags: S,Z,AC,P,C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::ADCM ()
+{
+    auto value = read();
+    return ADC(value);
+}
+
+// Code: ADI D8
+// Operation: (A) + D8 → A
+// Description: Add immediate to A
+// Flags: S,Z,AC,P,C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::ADI ()
+{
+    return ADDM();
+}
+
+// Code: ACI D8
+// Operation: (A) + D8 + C → A
+// Description: Add immediate to A with carry
+// Flags: S,Z,AC,P,C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::ACI  ()
+{
+    return ADCM();
+}
+
+// Code: DAD rp
+// Operation: (HL) + (RP) → HL
+// Description: Add part to H & L
+// Flags: C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::DAD  (uint16_t value)
+{
+    uint32_t hl  = readpair(HL);
+    uint32_t tmp = (uint32_t) value + hl;
+    writepair(HL, tmp & 0xFFFF);
+    
+    status.SetCarry((bool)(tmp & 0x10000L));
+    
+    return 0;
+}
+
+// Code: DAD rp
+// Operation: (HL) + (RP) → HL
+// Description: Add part to H & L
+// Flags: C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::DAD  ()
+{
+    uint16_t rpdata = readpair((opcode & 0x30) >> 4);
+    return DAD(rpdata);
+}
+
+// Code: DAD SP
+// Operation: (HL) + (SP) → HL
+// Description: Add part to H & L
+// Flags: C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::DADSP  ()
+{
+    return DAD(stack);
+}
+
+#pragma mark -
+#pragma mark Substract
+
+// Substract as addition of complement,
+// carry is inverted to get borrow
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::SUB(uint8_t data, uint8_t carry)
+{
+    uint8_t  value = ~data;
+    uint16_t acc = registers[A];
+    uint16_t tmp = acc + value + !carry;
+    registers[A] = tmp & 0x00FF;
+    
+    status.SetSubtract(tmp, tmp ^ acc ^ value);
+    
+    return 0;
+}
+
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::SBB(uint8_t data)
+{
+    auto carry = status.GetCarry();
+    return SUB (data, carry);
+}
+
+// Code: SUB r
+// Operation: (A) - (r) → A
+// Description: Substract register from A
+// Flags: S,Z,AC,P,C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::SUBR ()
+{
+    auto value = readsrc();
+    return SUB(value);
+}
+
+// Code: SUB M
+// Operation: (A) – М → A
+// Description: Substract memory from A
+// Flags: S,Z,AC,P,C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::SUBM ()
+{
+    auto value = read();
+    return SUB(value);
+}
+
+// Code: SBB r
+// Operation: (A) - (r) - C → A
+// Description: Substract register from A with borrow
+// Flags: S,Z,AC,P,C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::SBBR ()
+{
+    auto value = readsrc();
+    return SBB(value);
+}
+
+// Code: SBB M
+// Operation: (A) – М - C → A
+// Description: Substract memory from A with borrow
+// Flags: S,Z,AC,P,C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::SBBM ()
+{
+    auto value = read();
+    return SBB(value);
+}
+
+// Code: SUI D8
+// Operation: (A) - D8 → A
+// Description: Substract immediate from A
+// Flags: S,Z,AC,P,C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::SUI  ()
+{
+    return SUBM();
+}
+
+// Code: DBI D8
+// Operation: (A) - D8 - C → A
+// Description: Substract immediate from A with borrow
+// Flags: S,Z,AC,P,C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::SBI  ()
+{
+    return SBBM ();
+}
+
+#pragma mark -
+#pragma mark Logical
+
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::ANA  (uint8_t data)
+{
+    bool aux = ((registers[A] | data) & 0x08) != 0;
+    
+    registers[A] &= data;
+    status.SetLogical(registers[A], aux);
+    
+    return 0;
+}
+
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::XRA  (uint8_t data)
+{
+    registers[A] ^= data;
+    status.SetLogical(registers[A], false);
+    
+    return 0;
+}
+
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::ORA  (uint8_t data)
+{
+    registers[A] |= data;
+    status.SetLogical(registers[A], false);
+    
+    return 0;
+}
+
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::CMP (uint8_t value)
+{
+    uint8_t  data = ~value;
+    uint16_t acc = registers[A];
+    uint16_t tmp = acc + data + 1;
+    
+    status.SetSubtract(tmp, tmp ^ acc ^ data);
+    
+    return 0;
+}
+
+// Code: ANA r
+// Operation: (A) & (r) → A
+// Description: And register with A
+// Flags: S,Z,AC=*,P,C=0
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::ANAR ()
+{
+    auto value = readsrc();
+    return ANA(value);
+}
+
+// Code: ANA M
+// Operation: (A) & M → A
+// Description: And memory with A
+// Flags: S,Z,AC=*,P,C=0
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::ANAM ()
+{
+    auto value = read();
+    return ANA(value);
+}
+
+// Code: XRA r
+// Operation: (A) ^ r → A
+// Description: Exclusive or register with A
+// Flags: S,Z,AC=0,P,C=0
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::XRAR ()
+{
+    auto value = readsrc();
+    return XRA(value);
+}
+
+// Code: XRA M
+// Operation: (A) ^ M → A
+// Description: Exclusive or memory with A
+// Flags: S,Z,AC=0,P,C=0
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::XRAM ()
+{
+    auto value = read();
+    return XRA(value);
+}
+
+// Code: ORA r
+// Operation: (A) | r → A
+// Description: Or register with A
+// Flags: S,Z,AC,P,C=0
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::ORAR ()
+{
+    auto value = readsrc();
+    return ORA(value);
+}
+
+// Code: ORA M
+// Operation: (A) | М → A
+// Description: Or memory with A
+// Flags: S,Z,AC,P,C=0
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::ORAM ()
+{
+    auto value = read();
+    return ORA(value);
+}
+
+// Code: CMP r
+// Operation: Compare
+// Description: Comapre register with A
+// Flags: S,Z,AC,P,C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::CMPR ()
+{
+    auto value = readsrc();
+    return CMP(value);
+}
+
+// Code: CMP M
+// Operation: Compare
+// Description: Comapre memory with A
+// Flags: S,Z,AC,P,C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::CMPM ()
+{
+    auto value = read();
+    return CMP(value);
+}
+
+// Code: ANI 
+// Operation: (A) & D8 → A
+// Description: And immediate with A
+// Flags: S,Z,AC=*,P,C=0
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::ANI  ()
+{
+    auto value = read();
+    return ANA(value);
+}
+
+// Code: XRI
+// Operation: (A) ^ D8 → A
+// Description: Exclusive or immediate with A
+// Flags: S,Z,AC=0,P,C=0
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::XRI  ()
+{
+    uint8_t value = read();
+    return XRA(value);
+}
+
+// Code: ORI
+// Operation: (A) | D8 → A
+// Description: Or immediate with A
+// Flags: S,Z,AC=0,P,C=0
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::ORI  ()
+{
+    uint8_t value = read();
+    return ORA(value);
+}
+
+// Code: CPI
+// Operation: Compare
+// Description: Compare immediate with A
+// Flags: S,Z,AC,P,C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::CPI  ()
+{
+    uint8_t value = read();
+    return CMP(value);
+}
+
+#pragma mark -
+#pragma mark Rotate
+
+// Code: RLC
+// Operation: C ← A7, A0 ← A7
+// Description: Rotate A left
+// Flags: C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::RLC  ()
+{
+    uint8_t carry = (registers[A] & 0x80) >> 7;
+    registers[A] = (registers[A] << 1) | carry;
+    
+    status.SetCarry((bool) carry);
+    
+    return 0;
+}
+
+// Code: RRC
+// Operation: A7 → A0, A0 → C
+// Description: Rotate A right
+// Flags: C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::RRC  ()
+{
+    uint8_t carry = registers[A] & 0x01;
+    registers[A] = (registers[A] >> 1) | (carry << 7);
+    
+    status.SetCarry((bool) carry);
+    
+    return 0;
+}
+
+// Code: RAL
+// Operation: A7 → C, C → A0
+// Description: Rotate A left through carry
+// Flags: C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::RAL  ()
+{
+    uint8_t carry = (registers[A] & 0x80) >> 7;
+    registers[A] = (registers[A] << 1) | status.GetCarry();
+    
+    status.SetCarry((bool) carry);
+    
+    return 0;
+}
+
+// Code: RAL
+// Operation: A7 → C, C → A0
+// Description: Rotate A left through carry
+// Flags: C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::RAR  ()
+{
+    uint8_t carry = registers[A] & 0x01;
+    registers[A] = (registers[A] >> 1) | (status.GetCarry() << 7);
+    
+    status.SetCarry((bool) carry);
+    
+    return 0;
+}
+
+#pragma mark -
+#pragma mark Special
+
+// Code: CMA
+// Operation: ~(A)
+// Description: Complement A
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::CMA  ()
+{
+    registers[A] = ~registers[A];
+    return 0;
+}
+
+// Code: STC
+// Operation: C = 1
+// Description: Set carry
+// Flags: C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::STC  ()
+{
+    status.SetCarry(true);
+    return 0;
+}
+
+// Code: CMC
+// Operation: ~(C)
+// Description: Complement carry
+// Flags: C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::CMC  ()
+{
+    status.InvertCarry();
+    return 0;
+}
+
+// Code: DAA
+// Description: Decimal adjust A
+// Flags: S,Z,AC,P,C
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::DAA  ()
+{
+    uint8_t acc = registers[A];
+    uint8_t add = 0x00;
+    uint8_t crr = 0x00;
+    
+    if (status.GetAux() || (acc & 0x0F) > 0x09)
+    {
+        add = 0x06;
+    }
+
+    if (status.GetCarry()
+        ||  (acc >> 4) >  0x09
+        || ((acc >> 4) >= 0x09 && (acc & 0x0F) > 0x09))
+    {
+        add |= 0x60;
+        crr  = 0x01;
+    }
+    
+    ADD(add);
+    status.SetCarry((bool) crr);
+    
+    return 0;
+}
+
+#pragma mark -
+#pragma mark I/O
+
+// Code: IN
+// Operation: Input
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::IN ()
+{
+    uint8_t device = read();
+    registers[A] = io -> read(device);
+    
+    return 0;
+}
+
+// Code: OUT
+// Operation: Output
+// Flags: -
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::OUT ()
+{
+    uint8_t device = read();
+    uint8_t data = registers[A];
+    
+    io -> write(device, data);
+    
+    return 0;
+}
+
+#pragma mark -
+#pragma mark Control
+
+// Code: EI
+// Operation: Enable interrup
+// Flags: INTE
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::EI ()
+{
+    inte = true;
+    io -> enableInterrupt();
+    return 0;
+}
+
+// Code: DI
+// Operation: Disable interrup
+// Flags: DI
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::DI ()
+{
+    inte = false;
+    io -> disableInterrupt();
+    return 0;
+}
+
+// Code: HLT
+// Operation: Halt until interrupt
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::HLT ()
+{
+    halted = true;
+    return 0;
+}
+
+// Code: NOP
+// Operation: No-operation
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::NOP()
+{
+    return 0;
+}
+
+#pragma mark -
+#pragma mark Dispatch
+
+#ifdef SWITCH_DISPATCH
+
+// Same as commands table, but without indirect calls,
+// so the compiler is able to inline every operation
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::dispatch()
+{
+    switch (opcode)
+    {
+        case 0x00: case 0x08: case 0x10: case 0x18:
+        case 0x20: case 0x28: case 0x30: case 0x38:
+            IMP();
+            return NOP();
+
+        case 0x01: case 0x11: case 0x21:
+            DIR();
+            return LXI();
+
+        case 0x02: case 0x12:
+            IMP();
+            return STAX();
+
+        case 0x03: case 0x13: case 0x23:
+            IMP();
+            return INX();
+
+        case 0x04: case 0x0C: case 0x14: case 0x1C:
+        case 0x24: case 0x2C: case 0x3C:
+            IMP();
+            return INRR();
+
+        case 0x05: case 0x0D: case 0x15: case 0x1D:
+        case 0x25: case 0x2D: case 0x3D:
+            IMP();
+            return DCRR();
+
+        case 0x06: case 0x0E: case 0x16: case 0x1E:
+        case 0x26: case 0x2E: case 0x3E:
+            IMM();
+            return MVIR();
+
+        case 0x07:
+            IMP();
+            return RLC();
+
+        case 0x09: case 0x19: case 0x29:
+            IMP();
+            return DAD();
+
+        case 0x0A: case 0x1A:
+            IND();
+            return LDAX();
+
+        case 0x0B: case 0x1B: case 0x2B:
+            IMP();
+            return DCX();
+
+        case 0x0F:
+            IMP();
+            return RRC();
+
+        case 0x17:
+            IMP();
+            return RAL();
+
+        case 0x1F:
+            IMP();
+            return RAR();
+
+        case 0x22:
+            DIR();
+            return SHLD();
+
+        case 0x27:
+            IMP();
+            return DAA();
+
+        case 0x2A:
+            DIR();
+            return LHLD();
+
+        case 0x2F:
+            IMP();
+            return CMA();
+
+        case 0x31:
+            DIR();
+            return LXISP();
+
+        case 0x32:
+            DIR();
+            return STA();
+
+        case 0x33:
+            IMP();
+            return INXSP();
+
+        case 0x34:
+            HLM();
+            return INRM();
+
+        case 0x35:
+            HLM();
+            return DCRM();
+
+        case 0x36:
+            IMM();
+            return MVIM();
+
+        case 0x37:
+            IMP();
+            return STC();
+
+        case 0x39:
+            IMP();
+            return DADSP();
+
+        case 0x3A:
+            DIR();
+            return LDA();
+
+        case 0x3B:
+            IMP();
+            return DCXSP();
+
+        case 0x3F:
+            IMP();
+            return CMC();
+
+        case 0x40: case 0x41: case 0x42: case 0x43:
+        case 0x44: case 0x45: case 0x47: case 0x48:
+        case 0x49: case 0x4A: case 0x4B: case 0x4C:
+        case 0x4D: case 0x4F: case 0x50: case 0x51:
+        case 0x52: case 0x53: case 0x54: case 0x55:
+        case 0x57: case 0x58: case 0x59: case 0x5A:
+        case 0x5B: case 0x5C: case 0x5D: case 0x5F:
+        case 0x60: case 0x61: case 0x62: case 0x63:
+        case 0x64: case 0x65: case 0x67: case 0x68:
+        case 0x69: case 0x6A: case 0x6B: case 0x6C:
+        case 0x6D: case 0x6F: case 0x78: case 0x79:
+        case 0x7A: case 0x7B: case 0x7C: case 0x7D:
+        case 0x7F:
+            IMP();
+            return MOVRR();
+
+        case 0x46: case 0x4E: case 0x56: case 0x5E:
+        case 0x66: case 0x6E: case 0x7E:
+            HLM();
+            return MOVRM();
+
+        case 0x70: case 0x71: case 0x72: case 0x73:
+        case 0x74: case 0x75: case 0x77:
+            HLM();
+            return MOVMR();
+
+        case 0x76:
+            IMP();
+            return HLT();
+
+        case 0x80: case 0x81: case 0x82: case 0x83:
+        case 0x84: case 0x85: case 0x87:
+            IMP();
+            return ADDR();
+
+        case 0x86:
+            HLM();
+            return ADDM();
+
+        case 0x88: case 0x89: case 0x8A: case 0x8B:
+        case 0x8C: case 0x8D: case 0x8F:
+            IMP();
+            return ADCR();
+
+        case 0x8E:
+            HLM();
+            return ADCM();
+
+        case 0x90: case 0x91: case 0x92: case 0x93:
+        case 0x94: case 0x95: case 0x97:
+            IMP();
+            return SUBR();
+
+        case 0x96:
+            HLM();
+            return SUBM();
+
+        case 0x98: case 0x99: case 0x9A: case 0x9B:
+        case 0x9C: case 0x9D: case 0x9F:
+            IMP();
+            return SBBR();
+
+        case 0x9E:
+            HLM();
+            return SBBM();
+
+        case 0xA0: case 0xA1: case 0xA2: case 0xA3:
+        case 0xA4: case 0xA5: case 0xA7:
+            IMP();
+            return ANAR();
+
+        case 0xA6:
+            HLM();
+            return ANAM();
+
+        case 0xA8: case 0xA9: case 0xAA: case 0xAB:
+        case 0xAC: case 0xAD: case 0xAF:
+            IMP();
+            return XRAR();
+
+        case 0xAE:
+            HLM();
+            return XRAM();
+
+        case 0xB0: case 0xB1: case 0xB2: case 0xB3:
+        case 0xB4: case 0xB5: case 0xB7:
+            IMP();
+            return ORAR();
+
+        case 0xB6:
+            HLM();
+            return ORAM();
+
+        case 0xB8: case 0xB9: case 0xBA: case 0xBB:
+        case 0xBC: case 0xBD: case 0xBF:
+            IMP();
+            return CMPR();
+
+        case 0xBE:
+            HLM();
+            return CMPM();
+
+        case 0xC0:
+            IMP();
+            return RNZ();
+
+        case 0xC1: case 0xD1: case 0xE1:
+            IMP();
+            return POPR();
+
+        case 0xC2:
+            DIR();
+            return JNZ();
+
+        case 0xC3: case 0xCB:
+            DIR();
+            return JMP();
+
+        case 0xC4:
+            DIR();
+            return CNZ();
+
+        case 0xC5: case 0xD5: case 0xE5:
+            IMP();
+            return PUSHR();
+
+        case 0xC6:
+            IMM();
+            return ADI();
+
+        case 0xC7: case 0xCF: case 0xD7: case 0xDF:
+        case 0xE7: case 0xEF: case 0xF7: case 0xFF:
+            IMP();
+            return RST();
+
+        case 0xC8:
+            IMP();
+            return RZ();
+
+        case 0xC9: case 0xD9:
+            IMP();
+            return RET();
+
+        case 0xCA:
+            DIR();
+            return JZ();
+
+        case 0xCC:
+            DIR();
+            return CZ();
+
+        case 0xCD: case 0xDD: case 0xED: case 0xFD:
+            DIR();
+            return CALL();
+
+        case 0xCE:
+            IMM();
+            return ACI();
+
+        case 0xD0:
+            IMP();
+            return RNC();
+
+        case 0xD2:
+            DIR();
+            return JNC();
+
+        case 0xD3:
+            IMM();
+            return OUT();
+
+        case 0xD4:
+            DIR();
+            return CNC();
+
+        case 0xD6:
+            IMM();
+            return SUI();
+
+        case 0xD8:
+            IMP();
+            return RC();
+
+        case 0xDA:
+            DIR();
+            return JC();
+
+        case 0xDB:
+            IMM();
+            return IN();
+
+        case 0xDC:
+            DIR();
+            return CC();
+
+        case 0xDE:
+            IMM();
+            return SBI();
+
+        case 0xE0:
+            IMP();
+            return RPO();
+
+        case 0xE2:
+            DIR();
+            return JPO();
+
+        case 0xE3:
+            IMP();
+            return XTHL();
+
+        case 0xE4:
+            DIR();
+            return CPO();
+
+        case 0xE6:
+            IMM();
+            return ANI();
+
+        case 0xE8:
+            IMP();
+            return RPE();
+
+        case 0xE9:
+            IMP();
+            return PCHL();
+
+        case 0xEA:
+            DIR();
+            return JPE();
+
+        case 0xEB:
+            IMP();
+            return XCHG();
+
+        case 0xEC:
+            DIR();
+            return CPE();
+
+        case 0xEE:
+            IMM();
+            return XRI();
+
+        case 0xF0:
+            IMP();
+            return RP();
+
+        case 0xF1:
+            IMP();
+            return POP();
+
+        case 0xF2:
+            DIR();
+            return JP();
+
+        case 0xF3:
+            IMP();
+            return DI();
+
+        case 0xF4:
+            DIR();
+            return CP();
+
+        case 0xF5:
+            IMP();
+            return PUSH();
+
+        case 0xF6:
+            IMM();
+            return ORI();
+
+        case 0xF8:
+            IMP();
+            return RM();
+
+        case 0xF9:
+            IMP();
+            return SPHL();
+
+        case 0xFA:
+            DIR();
+            return JM();
+
+        case 0xFB:
+            IMP();
+            return EI();
+
+        case 0xFC:
+            DIR();
+            return CM();
+
+        case 0xFE:
+            IMM();
+            return CPI();
+    }
+    
+    return 0;
+}
+
+// Same as dispatch, for operations decoded ahead.
+// Only address modes depending on registers are evaluated
+template <class Bus, class Ports, class Policy>
+uint8_t BasicCpu<Bus, Ports, Policy>::operate()
+{
+    switch (opcode)
+    {
+        case 0x00: case 0x08: case 0x10: case 0x18:
+        case 0x20: case 0x28: case 0x30: case 0x38:
+            return NOP();
+
+        case 0x01: case 0x11: case 0x21:
+            return LXI();
+
+        case 0x02: case 0x12:
+            return STAX();
+
+        case 0x03: case 0x13: case 0x23:
+            return INX();
+
+        case 0x04: case 0x0C: case 0x14: case 0x1C:
+        case 0x24: case 0x2C: case 0x3C:
+            return INRR();
+
+        case 0x05: case 0x0D: case 0x15: case 0x1D:
+        case 0x25: case 0x2D: case 0x3D:
+            return DCRR();
+
+        case 0x06: case 0x0E: case 0x16: case 0x1E:
+        case 0x26: case 0x2E: case 0x3E:
+            return MVIR();
+
+        case 0x07:
+            return RLC();
+
+        case 0x09: case 0x19: case 0x29:
+            return DAD();
+
+        case 0x0A: case 0x1A:
+            IND();
+            return LDAX();
+
+        case 0x0B: case 0x1B: case 0x2B:
+            return DCX();
+
+        case 0x0F:
+            return RRC();
+
+        case 0x17:
+            return RAL();
+
+        case 0x1F:
+            return RAR();
+
+        case 0x22:
+            return SHLD();
+
+        case 0x27:
+            return DAA();
+
+        case 0x2A:
+            return LHLD();
+
+        case 0x2F:
+            return CMA();
+
+        case 0x31:
+            return LXISP();
+
+        case 0x32:
+            return STA();
+
+        case 0x33:
+            return INXSP();
+
+        case 0x34:
+            HLM();
+            return INRM();
+
+        case 0x35:
+            HLM();
+            return DCRM();
+
+        case 0x36:
+            return MVIM();
+
+        case 0x37:
+            return STC();
+
+        case 0x39:
+            return DADSP();
+
+        case 0x3A:
+            return LDA();
+
+        case 0x3B:
+            return DCXSP();
+
+        case 0x3F:
+            return CMC();
+
+        case 0x40: case 0x41: case 0x42: case 0x43:
+        case 0x44: case 0x45: case 0x47: case 0x48:
+        case 0x49: case 0x4A: case 0x4B: case 0x4C:
+        case 0x4D: case 0x4F: case 0x50: case 0x51:
+        case 0x52: case 0x53: case 0x54: case 0x55:
+        case 0x57: case 0x58: case 0x59: case 0x5A:
+        case 0x5B: case 0x5C: case 0x5D: case 0x5F:
+        case 0x60: case 0x61: case 0x62: case 0x63:
+        case 0x64: case 0x65: case 0x67: case 0x68:
+        case 0x69: case 0x6A: case 0x6B: case 0x6C:
+        case 0x6D: case 0x6F: case 0x78: case 0x79:
+        case 0x7A: case 0x7B: case 0x7C: case 0x7D:
+        case 0x7F:
+            return MOVRR();
+
+        case 0x46: case 0x4E: case 0x56: case 0x5E:
+        case 0x66: case 0x6E: case 0x7E:
+            HLM();
+            return MOVRM();
+
+        case 0x70: case 0x71: case 0x72: case 0x73:
+        case 0x74: case 0x75: case 0x77:
+            HLM();
+            return MOVMR();
+
+        case 0x76:
+            return HLT();
+
+        case 0x80: case 0x81: case 0x82: case 0x83:
+        case 0x84: case 0x85: case 0x87:
+            return ADDR();
+
+        case 0x86:
+            HLM();
+            return ADDM();
+
+        case 0x88: case 0x89: case 0x8A: case 0x8B:
+        case 0x8C: case 0x8D: case 0x8F:
+            return ADCR();
+
+        case 0x8E:
+            HLM();
+            return ADCM();
+
+        case 0x90: case 0x91: case 0x92: case 0x93:
+        case 0x94: case 0x95: case 0x97:
+            return SUBR();
+
+        case 0x96:
+            HLM();
+            return SUBM();
+
+        case 0x98: case 0x99: case 0x9A: case 0x9B:
+        case 0x9C: case 0x9D: case 0x9F:
+            return SBBR();
+
+        case 0x9E:
+            HLM();
+            return SBBM();
+
+        case 0xA0: case 0xA1: case 0xA2: case 0xA3:
+        case 0xA4: case 0xA5: case 0xA7:
+            return ANAR();
+
+        case 0xA6:
+            HLM();
+            return ANAM();
+
+        case 0xA8: case 0xA9: case 0xAA: case 0xAB:
+        case 0xAC: case 0xAD: case 0xAF:
+            return XRAR();
+
+        case 0xAE:
+            HLM();
+            return XRAM();
+
+        case 0xB0: case 0xB1: case 0xB2: case 0xB3:
+        case 0xB4: case 0xB5: case 0xB7:
+            return ORAR();
+
+        case 0xB6:
+            HLM();
+            return ORAM();
+
+        case 0xB8: case 0xB9: case 0xBA: case 0xBB:
+        case 0xBC: case 0xBD: case 0xBF:
+            return CMPR();
+
+        case 0xBE:
+            HLM();
+            return CMPM();
+
+        case 0xC0:
+            return RNZ();
+
+        case 0xC1: case 0xD1: case 0xE1:
+            return POPR();
+
+        case 0xC2:
+            return JNZ();
+
+        case 0xC3: case 0xCB:
+            return JMP();
+
+        case 0xC4:
+            return CNZ();
+
+        case 0xC5: case 0xD5: case 0xE5:
+            return PUSHR();
+
+        case 0xC6:
+            return ADI();
+
+        case 0xC7: case 0xCF: case 0xD7: case 0xDF:
+        case 0xE7: case 0xEF: case 0xF7: case 0xFF:
+            return RST();
+
+        case 0xC8:
+            return RZ();
+
+        case 0xC9: case 0xD9:
+            return RET();
+
+        case 0xCA:
+            return JZ();
+
+        case 0xCC:
+            return CZ();
+
+        case 0xCD: case 0xDD: case 0xED: case 0xFD:
+            return CALL();
+
+        case 0xCE:
+            return ACI();
+
+        case 0xD0:
+            return RNC();
+
+        case 0xD2:
+            return JNC();
+
+        case 0xD3:
+            return OUT();
+
+        case 0xD4:
+            return CNC();
+
+        case 0xD6:
+            return SUI();
+
+        case 0xD8:
+            return RC();
+
+        case 0xDA:
+            return JC();
+
+        case 0xDB:
+            return IN();
+
+        case 0xDC:
+            return CC();
+
+        case 0xDE:
+            return SBI();
+
+        case 0xE0:
+            return RPO();
+
+        case 0xE2:
+            return JPO();
+
+        case 0xE3:
+            return XTHL();
+
+        case 0xE4:
+            return CPO();
+
+        case 0xE6:
+            return ANI();
+
+        case 0xE8:
+            return RPE();
+
+        case 0xE9:
+            return PCHL();
+
+        case 0xEA:
+            return JPE();
+
+        case 0xEB:
+            return XCHG();
+
+        case 0xEC:
+            return CPE();
+
+        case 0xEE:
+            return XRI();
+
+        case 0xF0:
+            return RP();
+
+        case 0xF1:
+            return POP();
+
+        case 0xF2:
+            return JP();
+
+        case 0xF3:
+            return DI();
+
+        case 0xF4:
+            return CP();
+
+        case 0xF5:
+            return PUSH();
+
+        case 0xF6:
+            return ORI();
+
+        case 0xF8:
+            return RM();
+
+        case 0xF9:
+            return SPHL();
+
+        case 0xFA:
+            return JM();
+
+        case 0xFB:
+            return EI();
+
+        case 0xFC:
+            return CM();
+
+        case 0xFE:
+            return CPI();
+    }
+    
+    return 0;
+}
+
+#endif
+
+#endif /* CPU_TPP */
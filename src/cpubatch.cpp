@@ -0,0 +1,1013 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+
+#include "cpubatch.hpp"
+#include "cpu.tpp"
+
+// Lane memories are 64 KB and one cache line apart, the same
+// address of different lanes falls into different cache sets
+static const std::size_t stride = 0x10000 + 64;
+
+struct CpuBatch::Lane final : public IO<uint16_t>
+{
+    uint8_t * memory = nullptr;
+    
+    virtual uint8_t read(uint16_t address) const override {
+        return memory[address];
+    }
+    
+    virtual void write(uint16_t address, uint8_t data) override {
+        memory[address] = data;
+    }
+};
+
+// Lanes are indexes, loops over all of them can be vectorized
+struct CpuBatch::All
+{
+    std::size_t count;
+    
+    std::size_t size() const {
+        return count;
+    }
+    
+    std::size_t operator[] (std::size_t index) const {
+        return index;
+    }
+};
+
+struct CpuBatch::Listed
+{
+    const uint32_t * lanes;
+    std::size_t count;
+    
+    std::size_t size() const {
+        return count;
+    }
+    
+    std::size_t operator[] (std::size_t index) const {
+        return lanes[index];
+    }
+};
+
+template <class Lanes, class Kernel>
+static void each(const Lanes & lanes, Kernel kernel)
+{
+    for (std::size_t index = 0; index < lanes.size(); index++) {
+        kernel(lanes[index]);
+    }
+}
+
+CpuBatch::CpuBatch(std::size_t count) :
+    lanes   (count),
+    running (count),
+    status  (count, Status()),
+    stack   (count),
+    counter (count),
+    ticks   (count),
+    retired (count),
+    halted  (count),
+    memory  (count * stride),
+    slots   (0x10000),
+    member  (count),
+    order   (count),
+    lane    (std::make_shared<Lane>()),
+    scalar  (std::make_unique<Scalar>())
+{
+    for (auto & data : registers) {
+        data.resize(count);
+    }
+    
+    scalar -> connect(lane);
+}
+
+CpuBatch::~CpuBatch() = default;
+
+std::size_t CpuBatch::size() const
+{
+    return lanes;
+}
+
+void CpuBatch::connect(std::shared_ptr<IO<uint8_t>> io)
+{
+    scalar -> connect(io);
+}
+
+uint8_t * CpuBatch::base(std::size_t lane)
+{
+    return memory.data() + lane * stride;
+}
+
+uint16_t CpuBatch::readpair(std::size_t lane, uint8_t index) const
+{
+    if (index == 0x03) {
+        return stack[lane];
+    }
+    
+    return registers[index * 2][lane] << 8 | registers[index * 2 + 1][lane];
+}
+
+void CpuBatch::writepair(std::size_t lane, uint8_t index, uint16_t data)
+{
+    if (index == 0x03)
+    {
+        stack[lane] = data;
+        return;
+    }
+    
+    registers[index * 2][lane]     = data >> 8;
+    registers[index * 2 + 1][lane] = data & 0xFF;
+}
+
+bool CpuBatch::condition(std::size_t lane, uint8_t opcode) const
+{
+    // Flag of NZ/Z, NC/C, PO/PE and P/M
+    static const uint8_t flags[4] = { Status::Z, Status::C, Status::P, Status::S };
+    
+    bool set = (status[lane] & flags[(opcode >> 4) & 0x03]) != 0;
+    return (opcode & 0x08) ? set : !set;
+}
+
+#pragma mark -
+#pragma mark Execution
+
+uint64_t CpuBatch::step(uint64_t instructions)
+{
+    auto start = std::chrono::steady_clock::now();
+    uint64_t spent = 0;
+    uint64_t executed = 0;
+    
+    for (std::size_t index = 0; index < lanes; index++)
+    {
+        spent    -= ticks[index];
+        executed -= retired[index];
+    }
+    
+    for (uint64_t done = 0; done < instructions && running > 0; done++) {
+        advance();
+    }
+    
+    auto finish = std::chrono::steady_clock::now();
+    
+    for (std::size_t index = 0; index < lanes; index++)
+    {
+        spent    += ticks[index];
+        executed += retired[index];
+    }
+    
+    this -> instructions += executed;
+    this -> cycles  += spent;
+    this -> seconds += std::chrono::duration<double>(finish - start).count();
+    
+    return spent;
+}
+
+void CpuBatch::advance()
+{
+    // Usually every lane is at the same operation,
+    // then all of them are one group without sorting
+    if (running == lanes)
+    {
+        uint16_t address = counter[0];
+        uint8_t  opcode  = base(0)[address];
+        
+        std::size_t index = 1;
+        
+        while (index < lanes && counter[index] == address && base(index)[address] == opcode) {
+            index++;
+        }
+        
+        if (index == lanes)
+        {
+            if (execute(opcode, All { lanes }))
+            {
+                statistics.groups++;
+                statistics.grouped += lanes;
+                
+                return;
+            }
+            
+            for (index = 0; index < lanes; index++) {
+                execute(index);
+            }
+            
+            return;
+        }
+    }
+    
+    group();
+    
+    for (auto & group : groups)
+    {
+        Listed listed { order.data() + group.first, group.count };
+        
+        if (execute(group.opcode, listed))
+        {
+            statistics.groups++;
+            statistics.grouped += group.count;
+            
+            continue;
+        }
+        
+        for (std::size_t index = 0; index < listed.size(); index++) {
+            execute(listed[index]);
+        }
+    }
+}
+
+void CpuBatch::group()
+{
+    // Slots of previous steps are older generation
+    if (++generation == 0)
+    {
+        std::fill(slots.begin(), slots.end(), Slot());
+        generation = 1;
+    }
+    
+    groups.clear();
+    
+    for (std::size_t index = 0; index < lanes; index++)
+    {
+        if (halted[index]) {
+            continue;
+        }
+        
+        uint16_t address = counter[index];
+        uint8_t  opcode  = base(index)[address];
+        
+        auto & slot = slots[address];
+        
+        if (slot.generation != generation)
+        {
+            slot.generation = generation;
+            slot.group = (uint32_t) groups.size();
+            
+            groups.emplace_back();
+            groups.back().opcode = opcode;
+        }
+        
+        // Code differs at the same counter
+        // of lanes after self-modification
+        uint32_t current = slot.group;
+        
+        while (groups[current].opcode != opcode)
+        {
+            if (groups[current].next == UINT32_MAX)
+            {
+                groups[current].next = (uint32_t) groups.size();
+                
+                groups.emplace_back();
+                groups.back().opcode = opcode;
+            }
+            
+            current = groups[current].next;
+        }
+        
+        member[index] = current;
+        groups[current].count++;
+    }
+    
+    uint32_t first = 0;
+    
+    for (auto & group : groups)
+    {
+        group.first = first;
+        first += group.count;
+        group.count = 0;
+    }
+    
+    for (std::size_t index = 0; index < lanes; index++)
+    {
+        if (halted[index]) {
+            continue;
+        }
+        
+        auto & group = groups[member[index]];
+        order[group.first + group.count++] = (uint32_t) index;
+    }
+}
+
+void CpuBatch::execute(std::size_t lane)
+{
+    this -> lane -> memory = base(lane);
+    
+    for (uint8_t index = 0; index < 8; index++)
+    {
+        if (index != Cpu::M) {
+            scalar -> setRegister((Scalar::Registers) index, registers[index][lane]);
+        }
+    }
+    
+    scalar -> setPair(Scalar::PSW, registers[Cpu::A][lane] << 8 | status[lane]);
+    scalar -> setStack(stack[lane]);
+    scalar -> setCounter(counter[lane]);
+    
+    ticks[lane] += scalar -> step(1);
+    retired[lane]++;
+    
+    for (uint8_t index = 0; index < 8; index++)
+    {
+        if (index != Cpu::M) {
+            registers[index][lane] = scalar -> getRegister((Scalar::Registers) index);
+        }
+    }
+    
+    status[lane]  = scalar -> getPair(Scalar::PSW) & 0xFF;
+    stack[lane]   = scalar -> getStack();
+    counter[lane] = scalar -> getCounter();
+    
+    if (scalar -> isHalted())
+    {
+        halted[lane] = true;
+        running--;
+        
+        scalar -> reset();
+    }
+    
+    statistics.scalar++;
+}
+
+template <class Lanes>
+void CpuBatch::retire(const Lanes & lanes, uint8_t length, uint8_t cycles)
+{
+    each(lanes, [&](std::size_t lane)
+    {
+        counter[lane] += length;
+        ticks[lane]   += cycles;
+        retired[lane] += 1;
+    });
+}
+
+#pragma mark -
+#pragma mark Kernels
+
+template <class Lanes>
+bool CpuBatch::execute(uint8_t opcode, const Lanes & lanes)
+{
+    uint8_t cycles = Cpu::commands[opcode].cycles;
+    
+    if ((opcode & 0xC0) == 0x40 && opcode != 0x76)
+    {
+        move(lanes, opcode);
+        retire(lanes, 1, cycles);
+        
+        return true;
+    }
+    
+    if ((opcode & 0xC0) == 0x80 || (opcode & 0xC7) == 0xC6)
+    {
+        arithmetic(lanes, opcode);
+        retire(lanes, (opcode & 0x40) ? 2 : 1, cycles);
+        
+        return true;
+    }
+    
+    switch (opcode)
+    {
+        // NOP
+        case 0x00: case 0x08: case 0x10: case 0x18:
+        case 0x20: case 0x28: case 0x30: case 0x38:
+            break;
+            
+        // LXI rp, D16
+        case 0x01: case 0x11: case 0x21: case 0x31:
+            each(lanes, [&](std::size_t lane)
+            {
+                auto memory = base(lane);
+                uint16_t address = counter[lane];
+                
+                writepair(lane, opcode >> 4, memory[(uint16_t) (address + 1)] | memory[(uint16_t) (address + 2)] << 8);
+            });
+            
+            retire(lanes, 3, cycles);
+            return true;
+            
+        // STAX B, STAX D
+        case 0x02: case 0x12:
+            each(lanes, [&](std::size_t lane) {
+                base(lane)[readpair(lane, opcode >> 4)] = registers[Cpu::A][lane];
+            });
+            break;
+            
+        // LDAX B, LDAX D
+        case 0x0A: case 0x1A:
+            each(lanes, [&](std::size_t lane) {
+                registers[Cpu::A][lane] = base(lane)[readpair(lane, opcode >> 4)];
+            });
+            break;
+            
+        // INX rp
+        case 0x03: case 0x13: case 0x23: case 0x33:
+            each(lanes, [&](std::size_t lane) {
+                writepair(lane, opcode >> 4, readpair(lane, opcode >> 4) + 1);
+            });
+            break;
+            
+        // DCX rp
+        case 0x0B: case 0x1B: case 0x2B: case 0x3B:
+            each(lanes, [&](std::size_t lane) {
+                writepair(lane, opcode >> 4, readpair(lane, opcode >> 4) - 1);
+            });
+            break;
+            
+        // INR r, DCR r
+        case 0x04: case 0x0C: case 0x14: case 0x1C: case 0x24: case 0x2C: case 0x34: case 0x3C:
+        case 0x05: case 0x0D: case 0x15: case 0x1D: case 0x25: case 0x2D: case 0x35: case 0x3D:
+            increment(lanes, opcode);
+            break;
+            
+        // MVI r, D8
+        case 0x06: case 0x0E: case 0x16: case 0x1E: case 0x26: case 0x2E: case 0x36: case 0x3E:
+            each(lanes, [&](std::size_t lane)
+            {
+                auto memory = base(lane);
+                uint8_t data = memory[(uint16_t) (counter[lane] + 1)];
+                
+                if (opcode == 0x36) {
+                    memory[readpair(lane, 0x02)] = data;
+                } else {
+                    registers[opcode >> 3][lane] = data;
+                }
+            });
+            
+            retire(lanes, 2, cycles);
+            return true;
+            
+        // RLC, RRC, RAL, RAR
+        case 0x07: case 0x0F: case 0x17: case 0x1F:
+            rotate(lanes, opcode);
+            break;
+            
+        // DAD rp
+        case 0x09: case 0x19: case 0x29: case 0x39:
+            each(lanes, [&](std::size_t lane)
+            {
+                uint32_t sum = (uint32_t) readpair(lane, 0x02) + readpair(lane, opcode >> 4);
+                
+                writepair(lane, 0x02, sum & 0xFFFF);
+                status[lane] = (status[lane] & ~Status::C) | ((sum >> 16) & Status::C);
+            });
+            break;
+            
+        // SHLD, LHLD, STA, LDA
+        case 0x22: case 0x2A: case 0x32: case 0x3A:
+            direct(lanes, opcode);
+            retire(lanes, 3, cycles);
+            return true;
+            
+        // CMA
+        case 0x2F:
+            each(lanes, [&](std::size_t lane) {
+                registers[Cpu::A][lane] = ~registers[Cpu::A][lane];
+            });
+            break;
+            
+        // STC
+        case 0x37:
+            each(lanes, [&](std::size_t lane) {
+                status[lane] |= Status::C;
+            });
+            break;
+            
+        // CMC
+        case 0x3F:
+            each(lanes, [&](std::size_t lane) {
+                status[lane] ^= Status::C;
+            });
+            break;
+            
+        // XCHG
+        case 0xEB:
+            each(lanes, [&](std::size_t lane)
+            {
+                std::swap(registers[Cpu::D][lane], registers[Cpu::H][lane]);
+                std::swap(registers[Cpu::E][lane], registers[Cpu::L][lane]);
+            });
+            break;
+            
+        // Jcc, JMP
+        case 0xC2: case 0xCA: case 0xD2: case 0xDA: case 0xE2: case 0xEA: case 0xF2: case 0xFA:
+        case 0xC3: case 0xCB:
+            jump(lanes, opcode);
+            return true;
+            
+        // Ccc, CALL
+        case 0xC4: case 0xCC: case 0xD4: case 0xDC: case 0xE4: case 0xEC: case 0xF4: case 0xFC:
+        case 0xCD: case 0xDD: case 0xED: case 0xFD:
+            call(lanes, opcode);
+            return true;
+            
+        // Rcc, RET
+        case 0xC0: case 0xC8: case 0xD0: case 0xD8: case 0xE0: case 0xE8: case 0xF0: case 0xF8:
+        case 0xC9: case 0xD9:
+            ret(lanes, opcode);
+            return true;
+            
+        // PUSH rp, PUSH PSW
+        case 0xC5: case 0xD5: case 0xE5: case 0xF5:
+            push(lanes, opcode);
+            break;
+            
+        // POP rp, POP PSW
+        case 0xC1: case 0xD1: case 0xE1: case 0xF1:
+            pop(lanes, opcode);
+            break;
+            
+        default:
+            return false;
+    }
+    
+    retire(lanes, 1, cycles);
+    return true;
+}
+
+// MOV r, r / MOV r, M / MOV M, r
+template <class Lanes>
+void CpuBatch::move(const Lanes & lanes, uint8_t opcode)
+{
+    uint8_t target = (opcode >> 3) & 0x07;
+    uint8_t source = opcode & 0x07;
+    
+    if (source == Cpu::M)
+    {
+        each(lanes, [&](std::size_t lane) {
+            registers[target][lane] = base(lane)[readpair(lane, 0x02)];
+        });
+        
+        return;
+    }
+    
+    if (target == Cpu::M)
+    {
+        each(lanes, [&](std::size_t lane) {
+            base(lane)[readpair(lane, 0x02)] = registers[source][lane];
+        });
+        
+        return;
+    }
+    
+    auto & to   = registers[target];
+    auto & from = registers[source];
+    
+    each(lanes, [&](std::size_t lane) {
+        to[lane] = from[lane];
+    });
+}
+
+// ALU operation with register, memory or immediate
+template <class Lanes>
+void CpuBatch::arithmetic(const Lanes & lanes, uint8_t opcode)
+{
+    uint8_t source = (opcode & 0x40) ? 0x08 : opcode & 0x07;
+    auto & accumulator = registers[Cpu::A];
+    
+    auto operand = [&](std::size_t lane) -> uint8_t
+    {
+        switch (source)
+        {
+            case Cpu::M:
+                return base(lane)[readpair(lane, 0x02)];
+                
+            case 0x08:
+                return base(lane)[(uint16_t) (counter[lane] + 1)];
+        }
+        
+        return registers[source][lane];
+    };
+    
+    switch ((opcode >> 3) & 0x07)
+    {
+        // ADD, ADC
+        case 0x00:
+        case 0x01:
+        {
+            bool carry = (opcode & 0x08) != 0;
+            
+            each(lanes, [&](std::size_t lane)
+            {
+                uint16_t value = operand(lane);
+                uint16_t acc   = accumulator[lane];
+                uint16_t tmp   = acc + value + (carry ? status[lane] & Status::C : 0);
+                
+                accumulator[lane] = tmp & 0xFF;
+                status[lane] = Status::ArithmeticFlags(tmp, tmp ^ acc ^ value);
+            });
+            
+            break;
+        }
+            
+        // SUB, SBB, CMP
+        case 0x02:
+        case 0x03:
+        case 0x07:
+        {
+            bool borrow = ((opcode >> 3) & 0x07) == 0x03;
+            bool store  = ((opcode >> 3) & 0x07) != 0x07;
+            
+            each(lanes, [&](std::size_t lane)
+            {
+                uint8_t  value = ~operand(lane);
+                uint16_t acc   = accumulator[lane];
+                uint16_t tmp   = acc + value + !(borrow ? status[lane] & Status::C : 0);
+                
+                if (store) {
+                    accumulator[lane] = tmp & 0xFF;
+                }
+                
+                status[lane] = Status::SubtractFlags(tmp, tmp ^ acc ^ value);
+            });
+            
+            break;
+        }
+            
+        // ANA
+        case 0x04:
+            each(lanes, [&](std::size_t lane)
+            {
+                uint8_t value = operand(lane);
+                uint8_t aux   = ((accumulator[lane] | value) & 0x08) ? Status::AC : 0;
+                
+                accumulator[lane] &= value;
+                status[lane] = Status::LogicalFlags(accumulator[lane], aux);
+            });
+            
+            break;
+            
+        // XRA
+        case 0x05:
+            each(lanes, [&](std::size_t lane)
+            {
+                accumulator[lane] ^= operand(lane);
+                status[lane] = Status::LogicalFlags(accumulator[lane], 0);
+            });
+            
+            break;
+            
+        // ORA
+        case 0x06:
+            each(lanes, [&](std::size_t lane)
+            {
+                accumulator[lane] |= operand(lane);
+                status[lane] = Status::LogicalFlags(accumulator[lane], 0);
+            });
+            
+            break;
+    }
+}
+
+// INR r, INR M, DCR r, DCR M, carry is kept
+template <class Lanes>
+void CpuBatch::increment(const Lanes & lanes, uint8_t opcode)
+{
+    uint8_t target = (opcode >> 3) & 0x07;
+    bool decrement = (opcode & 0x01) != 0;
+    
+    each(lanes, [&](std::size_t lane)
+    {
+        uint8_t & data = (target == Cpu::M) ? base(lane)[readpair(lane, 0x02)] : registers[target][lane];
+        uint8_t carry = status[lane] & Status::C;
+        
+        if (decrement)
+        {
+            data--;
+            status[lane] = Status::DecrementFlags(data, carry);
+        }
+        else
+        {
+            data++;
+            status[lane] = Status::IncrementFlags(data, carry);
+        }
+    });
+}
+
+// RLC, RRC, RAL, RAR
+template <class Lanes>
+void CpuBatch::rotate(const Lanes & lanes, uint8_t opcode)
+{
+    auto & accumulator = registers[Cpu::A];
+    
+    each(lanes, [&](std::size_t lane)
+    {
+        uint8_t acc   = accumulator[lane];
+        uint8_t carry = status[lane] & Status::C;
+        
+        switch (opcode)
+        {
+            case 0x07: // RLC
+                carry = acc >> 7;
+                accumulator[lane] = (acc << 1) | carry;
+                break;
+                
+            case 0x0F: // RRC
+                carry = acc & 0x01;
+                accumulator[lane] = (acc >> 1) | (carry << 7);
+                break;
+                
+            case 0x17: // RAL
+                accumulator[lane] = (acc << 1) | carry;
+                carry = acc >> 7;
+                break;
+                
+            case 0x1F: // RAR
+                accumulator[lane] = (acc >> 1) | (carry << 7);
+                carry = acc & 0x01;
+                break;
+        }
+        
+        status[lane] = (status[lane] & ~Status::C) | carry;
+    });
+}
+
+// SHLD, LHLD, STA, LDA
+template <class Lanes>
+void CpuBatch::direct(const Lanes & lanes, uint8_t opcode)
+{
+    each(lanes, [&](std::size_t lane)
+    {
+        auto memory = base(lane);
+        uint16_t counter = this -> counter[lane];
+        uint16_t address = memory[(uint16_t) (counter + 1)] | memory[(uint16_t) (counter + 2)] << 8;
+        
+        switch (opcode)
+        {
+            case 0x22: // SHLD
+                memory[address] = registers[Cpu::L][lane];
+                memory[(uint16_t) (address + 1)] = registers[Cpu::H][lane];
+                break;
+                
+            case 0x2A: // LHLD
+                registers[Cpu::L][lane] = memory[address];
+                registers[Cpu::H][lane] = memory[(uint16_t) (address + 1)];
+                break;
+                
+            case 0x32: // STA
+                memory[address] = registers[Cpu::A][lane];
+                break;
+                
+            case 0x3A: // LDA
+                registers[Cpu::A][lane] = memory[address];
+                break;
+        }
+    });
+}
+
+// Jcc, JMP
+template <class Lanes>
+void CpuBatch::jump(const Lanes & lanes, uint8_t opcode)
+{
+    uint8_t cycles = Cpu::commands[opcode].cycles;
+    bool always = (opcode & 0x01) != 0;
+    
+    each(lanes, [&](std::size_t lane)
+    {
+        auto memory = base(lane);
+        uint16_t counter = this -> counter[lane];
+        
+        if (always || condition(lane, opcode)) {
+            this -> counter[lane] = memory[(uint16_t) (counter + 1)] | memory[(uint16_t) (counter + 2)] << 8;
+        } else {
+            this -> counter[lane] = counter + 3;
+        }
+        
+        ticks[lane]   += cycles;
+        retired[lane] += 1;
+    });
+}
+
+// Ccc, CALL. Taken Ccc takes 6 cycles more
+template <class Lanes>
+void CpuBatch::call(const Lanes & lanes, uint8_t opcode)
+{
+    uint8_t cycles = Cpu::commands[opcode].cycles;
+    bool always = (opcode & 0x01) != 0;
+    
+    each(lanes, [&](std::size_t lane)
+    {
+        auto memory = base(lane);
+        uint16_t counter = this -> counter[lane];
+        uint16_t next = counter + 3;
+        
+        ticks[lane]   += cycles;
+        retired[lane] += 1;
+        
+        if (!always && !condition(lane, opcode))
+        {
+            this -> counter[lane] = next;
+            return;
+        }
+        
+        memory[--stack[lane]] = next >> 8;
+        memory[--stack[lane]] = next & 0xFF;
+        
+        this -> counter[lane] = memory[(uint16_t) (counter + 1)] | memory[(uint16_t) (counter + 2)] << 8;
+        
+        if (!always) {
+            ticks[lane] += 6;
+        }
+    });
+}
+
+// Rcc, RET. Taken Rcc takes 6 cycles more
+template <class Lanes>
+void CpuBatch::ret(const Lanes & lanes, uint8_t opcode)
+{
+    uint8_t cycles = Cpu::commands[opcode].cycles;
+    bool always = (opcode & 0x01) != 0;
+    
+    each(lanes, [&](std::size_t lane)
+    {
+        auto memory = base(lane);
+        
+        ticks[lane]   += cycles;
+        retired[lane] += 1;
+        
+        if (!always && !condition(lane, opcode))
+        {
+            counter[lane]++;
+            return;
+        }
+        
+        uint8_t lo = memory[stack[lane]++];
+        uint8_t hi = memory[stack[lane]++];
+        
+        counter[lane] = hi << 8 | lo;
+        
+        if (!always) {
+            ticks[lane] += 6;
+        }
+    });
+}
+
+// PUSH rp, PUSH PSW
+template <class Lanes>
+void CpuBatch::push(const Lanes & lanes, uint8_t opcode)
+{
+    uint8_t index = (opcode >> 4) & 0x03;
+    
+    each(lanes, [&](std::size_t lane)
+    {
+        auto memory = base(lane);
+        
+        uint8_t hi = (index == 0x03) ? registers[Cpu::A][lane] : registers[index * 2][lane];
+        uint8_t lo = (index == 0x03) ? status[lane] : registers[index * 2 + 1][lane];
+        
+        memory[--stack[lane]] = hi;
+        memory[--stack[lane]] = lo;
+    });
+}
+
+// POP rp, POP PSW
+template <class Lanes>
+void CpuBatch::pop(const Lanes & lanes, uint8_t opcode)
+{
+    uint8_t index = (opcode >> 4) & 0x03;
+    
+    each(lanes, [&](std::size_t lane)
+    {
+        auto memory = base(lane);
+        
+        uint8_t lo = memory[stack[lane]++];
+        uint8_t hi = memory[stack[lane]++];
+        
+        if (index == 0x03)
+        {
+            registers[Cpu::A][lane] = hi;
+            status[lane] = Status(lo);
+        }
+        else
+        {
+            registers[index * 2][lane]     = hi;
+            registers[index * 2 + 1][lane] = lo;
+        }
+    });
+}
+
+#pragma mark -
+#pragma mark Statistics
+
+uint64_t CpuBatch::getInstructions() const
+{
+    return instructions;
+}
+
+uint64_t CpuBatch::getCycles() const
+{
+    return cycles;
+}
+
+double CpuBatch::getMips() const
+{
+    if (seconds == 0) {
+        return 0;
+    }
+    
+    return instructions / seconds / 1e6;
+}
+
+CpuBatch::Statistics CpuBatch::getStatistics() const
+{
+    return statistics;
+}
+
+#pragma mark -
+#pragma mark Lane state
+
+void CpuBatch::load(std::size_t lane, uint16_t address, const std::vector<uint8_t> & program)
+{
+    for (auto data : program) {
+        base(lane)[address++] = data;
+    }
+}
+
+uint8_t CpuBatch::getRegister(std::size_t lane, Registers index) const
+{
+    return registers[index][lane];
+}
+
+uint16_t CpuBatch::getPair(std::size_t lane, Pairs index) const
+{
+    if (index == Cpu::PSW) {
+        return registers[Cpu::A][lane] << 8 | status[lane];
+    }
+    
+    return readpair(lane, index);
+}
+
+uint16_t CpuBatch::getStack(std::size_t lane) const
+{
+    return stack[lane];
+}
+
+uint16_t CpuBatch::getCounter(std::size_t lane) const
+{
+    return counter[lane];
+}
+
+uint8_t CpuBatch::getMemory(std::size_t lane, uint16_t address) const
+{
+    return memory[lane * stride + address];
+}
+
+uint64_t CpuBatch::getClock(std::size_t lane) const
+{
+    return ticks[lane];
+}
+
+uint64_t CpuBatch::getInstructions(std::size_t lane) const
+{
+    return retired[lane];
+}
+
+bool CpuBatch::isHalted(std::size_t lane) const
+{
+    return halted[lane];
+}
+
+void CpuBatch::setRegister(std::size_t lane, Registers index, uint8_t data)
+{
+    registers[index][lane] = data;
+}
+
+void CpuBatch::setPair(std::size_t lane, Pairs index, uint16_t data)
+{
+    if (index == Cpu::PSW)
+    {
+        registers[Cpu::A][lane] = data >> 8;
+        status[lane] = Status(data & 0xFF);
+        
+        return;
+    }
+    
+    writepair(lane, index, data);
+}
+
+void CpuBatch::setStack(std::size_t lane, uint16_t stack)
+{
+    this -> stack[lane] = stack;
+}
+
+void CpuBatch::setCounter(std::size_t lane, uint16_t counter)
+{
+    this -> counter[lane] = counter;
+}
+
+void CpuBatch::setMemory(std::size_t lane, uint16_t address, uint8_t data)
+{
+    base(lane)[address] = data;
+}
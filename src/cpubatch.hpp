@@ -0,0 +1,195 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CPUBATCH_HPP
+#define CPUBATCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "cpu.hpp"
+
+// Processors executed in lockstep from arrays of state, one
+// array per register. Lanes at the same counter and operation
+// form a group, the operation is decoded once and executed
+// by one loop over the group. Operations without a kernel
+// (DAA, XTHL, PCHL, SPHL, RST, EI, DI, HLT, IN, OUT) are
+// executed lane by lane with Cpu code. Every lane has own
+// 64 KB memory, there are no traps, events and interrupts
+class CpuBatch
+{
+public:
+    
+    using Registers = Cpu::Registers;
+    using Pairs     = Cpu::Pairs;
+    
+    struct Statistics
+    {
+        uint64_t groups  = 0; // Operations decoded for groups
+        uint64_t grouped = 0; // Lane operations executed by groups
+        uint64_t scalar  = 0; // Lane operations executed by Cpu code
+    };
+    
+private:
+    
+    // Bus of scalar processor, memory of current lane
+    struct Lane;
+    
+    using Scalar = BasicCpu<Lane, IO<uint8_t>>;
+    
+    // Lanes of group, all lanes or listed ones
+    struct All;
+    struct Listed;
+    
+    // Lanes at the same counter, next is another
+    // group at this counter with other operation
+    struct Group
+    {
+        uint8_t  opcode = 0x00;
+        uint32_t first  = 0;
+        uint32_t count  = 0;
+        uint32_t next   = UINT32_MAX;
+    };
+    
+    // Group at counter in current step
+    struct Slot
+    {
+        uint32_t generation = 0;
+        uint32_t group      = 0;
+    };
+    
+    std::size_t lanes;
+    std::size_t running;
+    
+    // Lane state, index is lane number
+    std::vector<uint8_t>  registers[8];
+    std::vector<uint8_t>  status;
+    std::vector<uint16_t> stack;
+    std::vector<uint16_t> counter;
+    std::vector<uint64_t> ticks;
+    std::vector<uint64_t> retired;
+    std::vector<uint8_t>  halted;
+    
+    // Lane memories one after another, see stride
+    std::vector<uint8_t> memory;
+    
+    // Grouping of lanes in current step
+    std::vector<Group>    groups;
+    std::vector<Slot>     slots;
+    std::vector<uint32_t> member;
+    std::vector<uint32_t> order;
+    uint32_t generation = 0;
+    
+    // Processor executing operations without kernel
+    std::shared_ptr<Lane>   lane;
+    std::unique_ptr<Scalar> scalar;
+    
+    Statistics statistics;
+    
+    // Totals of all step() calls, halted
+    // lanes add only what they executed
+    uint64_t instructions = 0;
+    uint64_t cycles       = 0;
+    double   seconds      = 0;
+    
+private:
+    
+    uint8_t * base(std::size_t lane);
+    
+    // Pair 3 is stack pointer like in LXI, INX and DAD
+    uint16_t readpair (std::size_t lane, uint8_t index) const;
+    
+    void writepair (std::size_t lane, uint8_t index, uint16_t data);
+    
+    // Condition of Jcc, Ccc and Rcc operation
+    bool condition(std::size_t lane, uint8_t opcode) const;
+    
+    // Execute one operation on every running lane
+    void advance();
+    
+    // Sort running lanes into groups and order
+    void group();
+    
+    // Execute operation on lanes of group,
+    // false when operation has no kernel
+    template <class Lanes>
+    bool execute(uint8_t opcode, const Lanes & lanes);
+    
+    // Execute single operation with Cpu code
+    void execute(std::size_t lane);
+    
+    template <class Lanes>
+    void retire(const Lanes & lanes, uint8_t length, uint8_t cycles);
+    
+    // Kernels of operation classes
+    template <class Lanes> void move      (const Lanes & lanes, uint8_t opcode);
+    template <class Lanes> void arithmetic(const Lanes & lanes, uint8_t opcode);
+    template <class Lanes> void increment (const Lanes & lanes, uint8_t opcode);
+    template <class Lanes> void rotate    (const Lanes & lanes, uint8_t opcode);
+    template <class Lanes> void direct    (const Lanes & lanes, uint8_t opcode);
+    template <class Lanes> void jump      (const Lanes & lanes, uint8_t opcode);
+    template <class Lanes> void call      (const Lanes & lanes, uint8_t opcode);
+    template <class Lanes> void ret       (const Lanes & lanes, uint8_t opcode);
+    template <class Lanes> void push      (const Lanes & lanes, uint8_t opcode);
+    template <class Lanes> void pop       (const Lanes & lanes, uint8_t opcode);
+    
+public:
+    
+    CpuBatch(std::size_t count);
+    ~CpuBatch();
+    
+    std::size_t size() const;
+    
+    // Ports shared by all lanes
+    void connect(std::shared_ptr<IO<uint8_t>> io);
+    
+    // Execute instructions on every running lane
+    // and return cycles spent by all of them
+    uint64_t step(uint64_t instructions);
+    
+    uint64_t getInstructions() const;
+    uint64_t getCycles() const;
+    
+    // Aggregate speed of all lanes
+    double getMips() const;
+    
+    Statistics getStatistics() const;
+    
+    // Lane state, the same as of Cpu
+    void load(std::size_t lane, uint16_t address, const std::vector<uint8_t> & program);
+    
+    uint8_t  getRegister(std::size_t lane, Registers index) const;
+    uint16_t getPair    (std::size_t lane, Pairs index) const;
+    uint16_t getStack   (std::size_t lane) const;
+    uint16_t getCounter (std::size_t lane) const;
+    uint8_t  getMemory  (std::size_t lane, uint16_t address) const;
+    uint64_t getClock   (std::size_t lane) const;
+    
+    uint64_t getInstructions(std::size_t lane) const;
+    
+    bool isHalted(std::size_t lane) const;
+    
+    void setRegister(std::size_t lane, Registers index, uint8_t data);
+    void setPair    (std::size_t lane, Pairs index, uint16_t data);
+    void setStack   (std::size_t lane, uint16_t stack);
+    void setCounter (std::size_t lane, uint16_t counter);
+    void setMemory  (std::size_t lane, uint16_t address, uint8_t data);
+};
+
+#endif /* CPUBATCH_HPP */
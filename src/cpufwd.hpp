@@ -15,15 +15,19 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "cpu.hpp"
-#include "command.hpp"
+#ifndef CPUFWD_HPP
+#define CPUFWD_HPP
 
-bool Command::isImplied()
-{
-    return addrmod == &Cpu::IMP;
-}
+#include <cstdint>
 
-bool Command::isIndirect()
-{
-    return addrmod == &Cpu::DIR;
-}
+#include "IO.hpp"
+#include "status.hpp"
+
+// Policy is Eager or Lazy status, see BasicStatus
+template <class Bus, class Ports, class Policy = StatusPolicy>
+class BasicCpu;
+
+// Processor with devices behind virtual IO
+using Cpu = BasicCpu<IO<uint16_t>, IO<uint8_t>>;
+
+#endif /* CPUFWD_HPP */
@@ -19,12 +19,15 @@
 #include <array>
 
 #include "IO.hpp"
+#include "bdos.hpp"
+#include "console.hpp"
 #include "cpu.hpp"
+#include "memory.hpp"
 
 // Test starting at
 static const uint16_t offset = 0x0100;
 
-class Bus : public IO<uint16_t>
+class Bus : public Memory
 {
 private:
     // 64 KB
@@ -34,19 +37,21 @@ private:
     // Memory array
     ram memory {};
     
+    // Direct access to memory array
+    Pages table;
+    
     // Bus test initializer
     friend void load(std::string path, const std::shared_ptr<Bus> & bus);
     
 public:
     Bus()
     {
+        for (uint16_t page = 0; page < 256; page++) {
+            table.read[page] = table.write[page] = memory.data() + (page << 8);
+        }
+        
         write(0x0000, 0xD3); // 0000: OUT 00
         write(0x0001, 0x00);
-        
-        write(0x0005, 0xD3); // 0005: OUT 01
-        write(0x0006, 0x01);
-        
-        write(0x0007, 0xC9); // 0007: RET
     }
     
     virtual uint8_t read(uint16_t address) const override {
@@ -57,6 +62,10 @@ public:
         memory[address] = data;
     }
     
+    virtual const Pages & pages() const override {
+        return table;
+    }
+    
 private:
     ram::iterator begin()
     {
@@ -92,8 +101,15 @@ void execute(std::string exerciser)
     auto bus = std::make_shared<Bus>();
     auto cpu = std::make_unique<Cpu>();
     
+    // Guest output is buffered and written to stdout
+    auto console = std::make_shared<Console>(std::make_shared<StreamSink>(std::cout));
+    
     // Communication betweet RAM and CPU
     cpu -> connect(bus);
+    cpu -> connect(console);
+    
+    // CP/M calls at 0005 are executed by host
+    Bdos::install(*cpu, std::make_shared<Bdos>(console));
     
     // Set program counter to begin test (0x0100)
     cpu -> setCounter(offset);
@@ -102,22 +118,22 @@ void execute(std::string exerciser)
 
     while (cpu -> getCounter() > 0)
     {
-        // Result will be recieve in OUT operation
-        // See Cpu::OUT method for more information
+        // Result will be printed by BDOS functions 2 and 9
+        // See Bdos::call method for more information
         
-        cpu -> clock();
+        cpu -> step();
     }
+    
+    console -> flush();
+    
+#ifdef ASMLOG
+    // Operations executed before exit
+    cpu -> getTrace().print(std::cout);
+#endif
 }
 
 int main(int argc, const char * argv[])
 {
-#ifndef LOGTEST
-    std::cout << "Recomplile with -DLOGTEST key for run tests";
-    std::cout << std::endl;
-    
-    return 0;
-#endif
-    
     const std::string exercisers[4]
     {
         "../asm/CPUTEST.com",
@@ -0,0 +1,352 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+#include "fleet.hpp"
+
+// Affinity of calling thread, it is pinned by run()
+// only while it executes processors with pool threads
+class Affinity
+{
+#ifdef __linux__
+private:
+    cpu_set_t set;
+    bool saved = false;
+    
+public:
+    Affinity(bool pinning)
+    {
+        if (pinning) {
+            saved = pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+        }
+    }
+    
+    ~Affinity()
+    {
+        if (saved) {
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        }
+    }
+#else
+public:
+    Affinity(bool)
+    {
+        
+    }
+#endif
+};
+
+Fleet::Fleet(unsigned threads)
+{
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    
+    for (unsigned thread = 0; thread < threads; thread++) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    
+    for (std::size_t thread = 1; thread < queues.size(); thread++) {
+        workers.emplace_back(&Fleet::serve, this, thread);
+    }
+}
+
+Fleet::~Fleet()
+{
+    {
+        std::lock_guard<std::mutex> lock(control);
+        stopping = true;
+    }
+    
+    wake.notify_all();
+    
+    for (auto & worker : workers) {
+        worker.join();
+    }
+}
+
+std::size_t Fleet::add(std::unique_ptr<Cpu> cpu)
+{
+    auto instance = std::make_unique<Instance>();
+    instance -> cpu = std::move(cpu);
+    
+    instances.push_back(std::move(instance));
+    return instances.size() - 1;
+}
+
+Cpu & Fleet::operator[] (std::size_t index)
+{
+    return *instances[index] -> cpu;
+}
+
+std::size_t Fleet::size() const
+{
+    return instances.size();
+}
+
+void Fleet::setSlice(uint64_t cycles)
+{
+    slice = std::max<uint64_t>(cycles, 1);
+}
+
+void Fleet::setPinning(bool pinning)
+{
+    this -> pinning = pinning;
+}
+
+#pragma mark -
+#pragma mark Execution
+
+void Fleet::run(uint64_t cycles)
+{
+    auto start = std::chrono::steady_clock::now();
+    uint64_t before = 0;
+    
+    // Neighbouring processors start on different threads
+    for (std::size_t index = 0; index < instances.size(); index++)
+    {
+        before += instances[index] -> cycles;
+        
+        instances[index] -> target = instances[index] -> cycles + cycles;
+        queues[index % queues.size()] -> instances.push_back(index);
+    }
+    
+    queued    = instances.size();
+    remaining = instances.size();
+    
+    {
+        std::lock_guard<std::mutex> lock(control);
+        
+        generation++;
+        busy = workers.size();
+    }
+    
+    wake.notify_all();
+    
+    // Calling thread is a worker too
+    {
+        Affinity affinity(pinning);
+        work(0);
+    }
+    
+    {
+        // Processors are not touched after pool threads left the run
+        std::unique_lock<std::mutex> lock(control);
+        done.wait(lock, [this] { return busy == 0; });
+    }
+    
+    auto finish = std::chrono::steady_clock::now();
+    
+    for (auto & instance : instances) {
+        this -> cycles += instance -> cycles;
+    }
+    
+    this -> cycles  -= before;
+    this -> seconds += std::chrono::duration<double>(finish - start).count();
+}
+
+void Fleet::serve(std::size_t thread)
+{
+    uint64_t seen = 0;
+    
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(control);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            
+            if (stopping) {
+                return;
+            }
+            
+            seen = generation;
+        }
+        
+        work(thread);
+        
+        bool last;
+        
+        {
+            std::lock_guard<std::mutex> lock(control);
+            last = --busy == 0;
+        }
+        
+        if (last) {
+            done.notify_one();
+        }
+    }
+}
+
+void Fleet::work(std::size_t thread)
+{
+    if (pinning) {
+        pin(thread);
+    }
+    
+    std::size_t index;
+    
+    while (remaining > 0)
+    {
+        if (!take(thread, index))
+        {
+            // Last processors are running on other threads
+            park();
+            continue;
+        }
+        
+        auto & instance = *instances[index];
+        auto start = std::chrono::steady_clock::now();
+        
+        // Processor is touched only by this thread until it is queued again
+        uint64_t limit = std::min(slice, instance.target - instance.cycles);
+        instance.cycles += instance.cpu -> run(limit);
+        
+        auto finish = std::chrono::steady_clock::now();
+        instance.seconds += std::chrono::duration<double>(finish - start).count();
+        
+        if (instance.cycles < instance.target)
+        {
+            put(thread, index);
+            continue;
+        }
+        
+        if (--remaining == 0)
+        {
+            // Lock orders the store before parked threads check it
+            std::lock_guard<std::mutex> lock(control);
+            ready.notify_all();
+        }
+    }
+}
+
+void Fleet::put(std::size_t thread, std::size_t index)
+{
+    auto & queue = *queues[thread];
+    
+    // Counted before push, so take() never counts below zero
+    queued++;
+    
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.instances.push_back(index);
+    }
+    
+    // Parked thread counts itself before checking queued
+    if (parked > 0)
+    {
+        std::lock_guard<std::mutex> lock(control);
+        ready.notify_one();
+    }
+}
+
+void Fleet::park()
+{
+    std::unique_lock<std::mutex> lock(control);
+    
+    parked++;
+    ready.wait(lock, [this] { return queued > 0 || remaining == 0; });
+    parked--;
+}
+
+bool Fleet::take(std::size_t thread, std::size_t & index)
+{
+    if (queued == 0) {
+        return false;
+    }
+    
+    for (std::size_t offset = 0; offset < queues.size(); offset++)
+    {
+        auto & queue = *queues[(thread + offset) % queues.size()];
+        
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        
+        if (queue.instances.empty()) {
+            continue;
+        }
+        
+        // Own processors are taken from the front, stolen from the back
+        if (offset == 0)
+        {
+            index = queue.instances.front();
+            queue.instances.pop_front();
+        }
+        else
+        {
+            index = queue.instances.back();
+            queue.instances.pop_back();
+        }
+        
+        queued--;
+        return true;
+    }
+    
+    return false;
+}
+
+void Fleet::pin(std::size_t thread)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    
+    CPU_ZERO(&set);
+    CPU_SET(thread % std::max(std::thread::hardware_concurrency(), 1U), &set);
+    
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void) thread;
+#endif
+}
+
+#pragma mark -
+#pragma mark Statistics
+
+uint64_t Fleet::getCycles(std::size_t index) const
+{
+    return instances[index] -> cycles;
+}
+
+double Fleet::getHertz(std::size_t index) const
+{
+    auto & instance = *instances[index];
+    
+    if (instance.seconds == 0) {
+        return 0;
+    }
+    
+    return instance.cycles / instance.seconds;
+}
+
+uint64_t Fleet::getCycles() const
+{
+    return cycles;
+}
+
+double Fleet::getHertz() const
+{
+    if (seconds == 0) {
+        return 0;
+    }
+    
+    return cycles / seconds;
+}
@@ -0,0 +1,138 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FLEET_HPP
+#define FLEET_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "cpu.hpp"
+
+// Independent processors executed on a pool of host threads.
+// Every thread runs its own processors slice by slice and
+// steals processors of other threads when it has none left.
+// Threads live as long as the fleet and sleep between runs
+class Fleet
+{
+private:
+    
+    // Processor with its bus, owned by single thread at a time
+    struct Instance
+    {
+        std::unique_ptr<Cpu> cpu;
+        
+        uint64_t target  = 0; // Cycles to reach in run()
+        uint64_t cycles  = 0; // Cycles executed
+        double   seconds = 0; // Time spent executing
+    };
+    
+    // Processors waiting for the next slice
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::size_t> instances;
+    };
+    
+    std::vector<std::unique_ptr<Instance>> instances;
+    std::vector<std::unique_ptr<Queue>> queues;
+    
+    // Processors not finished in current run()
+    std::atomic<std::size_t> remaining { 0 };
+    
+    // Processors waiting in all queues
+    std::atomic<std::size_t> queued { 0 };
+    
+    // Threads sleeping until processor is queued
+    std::atomic<std::size_t> parked { 0 };
+    
+    // Pool threads, calling thread of run() is thread 0
+    std::vector<std::thread> workers;
+    
+    std::mutex control;
+    std::condition_variable wake;  // Run started or fleet destroyed
+    std::condition_variable ready; // Processor queued or run finished
+    std::condition_variable done;  // Pool thread left the run
+    
+    uint64_t generation = 0; // Number of run() calls
+    std::size_t busy    = 0; // Pool threads inside current run()
+    bool stopping       = false;
+    
+    // Cycles per slice
+    uint64_t slice = 100000;
+    
+    // Bind thread to host core
+    bool pinning = false;
+    
+    // Totals of all run() calls
+    uint64_t cycles  = 0;
+    double   seconds = 0;
+    
+    // Body of pool thread
+    void serve(std::size_t thread);
+    
+    void work(std::size_t thread);
+    
+    // Queue processor and wake parked thread
+    void put(std::size_t thread, std::size_t index);
+    
+    // Sleep until processor is queued or run is finished
+    void park();
+    
+    // Take processor from own queue or from another thread
+    bool take(std::size_t thread, std::size_t & index);
+    
+    static void pin(std::size_t thread);
+    
+public:
+    
+    // Zero threads means one thread per host core
+    Fleet(unsigned threads = 0);
+    ~Fleet();
+    
+    Fleet(const Fleet &) = delete;
+    Fleet & operator= (const Fleet &) = delete;
+    
+    // Processor must be connected to its own bus
+    std::size_t add(std::unique_ptr<Cpu> cpu);
+    
+    Cpu & operator[] (std::size_t index);
+    std::size_t size() const;
+    
+    void setSlice  (uint64_t cycles);
+    void setPinning(bool pinning);
+    
+    // Execute cycles on every processor
+    void run(uint64_t cycles);
+    
+    // Cycles per second of single processor
+    uint64_t getCycles(std::size_t index) const;
+    double   getHertz (std::size_t index) const;
+    
+    // Cycles per second of whole fleet
+    uint64_t getCycles() const;
+    double   getHertz () const;
+};
+
+#endif /* FLEET_HPP */
@@ -0,0 +1,1086 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "jit.hpp"
+#include "status.hpp"
+
+// Status bits tested by Jcc: Z, C, P and S
+static const uint8_t conditions[4] = { 0x40, 0x01, 0x04, 0x80 };
+
+// x86 condition codes
+static const uint8_t below    = 0x02;
+static const uint8_t equal    = 0x04;
+static const uint8_t notequal = 0x05;
+
+// Registers of 8080 in operation code order
+static const uint8_t H = 4;
+static const uint8_t L = 5;
+static const uint8_t M = 6;
+static const uint8_t A = 7;
+
+Jit::Jit(BlockCache & cache) : cache(cache)
+{
+    std::memcpy(tables, Status::szp, sizeof(Status::szp));
+    std::memcpy(tables + 256, Status::add, sizeof(Status::add));
+    
+    bits = &cache.code[0][0];
+    
+    // Pages are writable or executable, never both, see install()
+    void * memory = mmap(nullptr, capacity, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    
+    // Blocks stay interpreted without executable memory
+    if (memory != MAP_FAILED) {
+        buffer = (uint8_t *) memory;
+    }
+}
+
+Jit::~Jit()
+{
+    if (buffer != nullptr) {
+        munmap(buffer, capacity);
+    }
+}
+
+void Jit::heat(const Block & block)
+{
+    if (buffer == nullptr || block.runs >= threshold) {
+        return;
+    }
+    
+    if (++block.runs == threshold) {
+        block.native = translate(block);
+    }
+}
+
+const Jit::Statistics & Jit::statistics() const
+{
+    return counters;
+}
+
+#pragma mark -
+#pragma mark Translation
+
+// Jumps, calls and returns set counter themselves
+static bool transfers(uint8_t opcode)
+{
+    switch (opcode)
+    {
+        case 0xC3: // JMP
+        case 0xCB: // JMP
+        case 0xC9: // RET
+        case 0xD9: // RET
+        case 0xCD: // CALL
+        case 0xDD: // CALL
+        case 0xED: // CALL
+        case 0xFD: // CALL
+        case 0xE9: // PCHL
+            return true;
+    }
+    
+    // Jcc
+    return (opcode & 0xC7) == 0xC2;
+}
+
+// Host code returns cycles << 8 | operations executed.
+// Exits jump to stubs returning the same for operations
+// before the one which has to be interpreted
+Native Jit::translate(const Block & block)
+{
+    auto & operations = block.operations;
+    
+    output.clear();
+    exits.clear();
+    
+    load(RSI, Mem(RDI, offsets.pages));
+    move(R8,  tables);
+    move(R11, bits);
+    
+    std::size_t index = 0;
+    
+    while (index < operations.size() && operation(block, index)) {
+        index++;
+    }
+    
+    if (index == 0) {
+        return nullptr;
+    }
+    
+    // Cycles of operations before index
+    std::vector<uint32_t> cycles(index + 1);
+    
+    for (std::size_t done = 0; done < index; done++) {
+        cycles[done + 1] = cycles[done] + operations[done].cycles;
+    }
+    
+    auto & last = operations[index - 1];
+    
+    if (!transfers(last.opcode)) {
+        store16(Mem(RDI, offsets.counter), last.next);
+    }
+    
+    // Interrupt is delayed after EI only, which is not translated
+    store8(Mem(RDI, offsets.opcode), last.opcode);
+    
+    move(RAX, cycles[index] << 8 | (uint32_t) index);
+    ret();
+    
+    std::vector<std::size_t> stubs(index, SIZE_MAX);
+    
+    for (auto & exit : exits)
+    {
+        if (stubs[exit.index] == SIZE_MAX)
+        {
+            stubs[exit.index] = output.size();
+            
+            move(RAX, cycles[exit.index] << 8 | (uint32_t) exit.index);
+            ret();
+        }
+        
+        int32_t offset = (int32_t) (stubs[exit.index] - (exit.patch + 4));
+        std::memcpy(&output[exit.patch], &offset, sizeof(offset));
+    }
+    
+    // Blocks of full buffer are dropped, running one included.
+    // It is interpreted to the end and fetched again
+    if (used + output.size() > capacity)
+    {
+        cache.clear();
+        
+        used = 0;
+        counters.resets++;
+        
+        return nullptr;
+    }
+    
+    auto native = buffer + used;
+    
+    // Without executable memory every block is interpreted,
+    // blocks translated before are dropped with the buffer
+    if (!install(native))
+    {
+        cache.clear();
+        munmap(buffer, capacity);
+        
+        buffer = nullptr;
+        return nullptr;
+    }
+    
+    used += output.size();
+    
+    counters.translated++;
+    counters.operations += index;
+    
+    return (Native) native;
+}
+
+// Pages receiving code are made writable for the copy
+// and executable again, no page is both at any time
+bool Jit::install(uint8_t * native)
+{
+    static const uintptr_t page = (uintptr_t) sysconf(_SC_PAGESIZE);
+    
+    auto first = (uint8_t *) ((uintptr_t) native & ~(page - 1));
+    auto last  = (uint8_t *) (((uintptr_t) native + output.size() + page - 1) & ~(page - 1));
+    
+    std::size_t size = (std::size_t) (last - first);
+    
+    if (mprotect(first, size, PROT_READ | PROT_WRITE) != 0) {
+        return false;
+    }
+    
+    std::memcpy(native, output.data(), output.size());
+    
+    return mprotect(first, size, PROT_READ | PROT_EXEC) == 0;
+}
+
+// Every operation checks everything before it changes
+// state, so exit leaves state before the operation
+bool Jit::operation(const Block & block, std::size_t index)
+{
+    auto & operation = block.operations[index];
+    
+    uint8_t code        = operation.opcode;
+    uint8_t destination = (code >> 3) & 0x07;
+    uint8_t source      = code & 0x07;
+    uint8_t pair        = (code >> 4) & 0x03;
+    
+    // Immediate byte, block never crosses page
+    uint8_t data = block.host[operation.address & 0xFF];
+    
+    auto reg = [this](uint8_t index) {
+        return Mem(RDI, offsets.registers + index);
+    };
+    
+    Mem flags(RDI, offsets.status);
+    Mem sp(RDI, offsets.stack);
+    
+    // NOP
+    if ((code & 0xC7) == 0x00) {
+        return true;
+    }
+    
+    // MOV, except HLT
+    if ((code & 0xC0) == 0x40 && code != 0x76)
+    {
+        if (destination == M)
+        {
+            movzx8(R9, reg(source));
+            
+            readpair(2);
+            writable(index);
+            store();
+            
+            return true;
+        }
+        
+        if (source == M)
+        {
+            readpair(2);
+            read(index);
+        }
+        else {
+            movzx8(RAX, reg(source));
+        }
+        
+        store8(reg(destination), RAX);
+        return true;
+    }
+    
+    // MVI
+    if ((code & 0xC7) == 0x06)
+    {
+        if (destination == M)
+        {
+            move(R9, data);
+            
+            readpair(2);
+            writable(index);
+            store();
+            
+            return true;
+        }
+        
+        store8(reg(destination), data);
+        return true;
+    }
+    
+    // LXI
+    if ((code & 0xCF) == 0x01)
+    {
+        if (pair == 3) {
+            store16(sp, operation.address);
+        }
+        else {
+            store16(reg(pair * 2), (uint16_t) (operation.address >> 8 | operation.address << 8));
+        }
+        
+        return true;
+    }
+    
+    // INX, DCX
+    if ((code & 0xC7) == 0x03)
+    {
+        uint8_t extension = code & 0x08 ? 5 : 0;
+        
+        if (pair == 3) {
+            alu16(extension, sp, 1);
+        }
+        else
+        {
+            readpair(pair);
+            alu(extension, RDX, 1);
+            writepair(pair);
+        }
+        
+        return true;
+    }
+    
+    // DAD
+    if ((code & 0xCF) == 0x09)
+    {
+        readpair(2);
+        
+        if (pair == 3) {
+            movzx16(RCX, sp);
+        }
+        else
+        {
+            movzx16(RCX, reg(pair * 2));
+            swap16(RCX);
+        }
+        
+        alu(0, RDX, RCX);
+        move(RAX, RDX);
+        shift(5, RAX, 16);
+        writepair(2);
+        
+        carry(RAX);
+        return true;
+    }
+    
+    // INR, DCR
+    if ((code & 0xC6) == 0x04 && destination != M)
+    {
+        bool decrement = code & 0x01;
+        
+        movzx8(RCX, reg(destination));
+        alu(decrement ? 5 : 0, RCX, 1);
+        store8(reg(destination), RCX);
+        
+        movzx8(RCX, RCX);
+        movzx8(RDX, Mem(R8, 0, RCX));
+        
+        // Auxiliary carry from low nibble
+        alu(6, RAX, RAX);
+        move(R9, RCX);
+        alu(4, R9, 0x0F);
+        
+        if (decrement)
+        {
+            alu(7, R9, 0x0F);
+            set(notequal, RAX);
+        }
+        else {
+            set(equal, RAX);
+        }
+        
+        shift(4, RAX, 4);
+        alu(1, RDX, RAX);
+        
+        movzx8(RAX, flags);
+        alu(4, RAX, 0x01);
+        alu(1, RDX, RAX);
+        store8(flags, RDX);
+        
+        return true;
+    }
+    
+    // ALU with register, memory or immediate
+    if ((code & 0xC0) == 0x80 || (code & 0xC7) == 0xC6)
+    {
+        if ((code & 0xC0) == 0xC0) {
+            move(RCX, data);
+        }
+        else if (source == M)
+        {
+            readpair(2);
+            read(index);
+            move(RCX, RAX);
+        }
+        else {
+            movzx8(RCX, reg(source));
+        }
+        
+        movzx8(RAX, reg(A));
+        
+        switch (destination)
+        {
+            // ADD, ADC
+            case 0:
+            case 1:
+                if (destination == 1)
+                {
+                    movzx8(RDX, flags);
+                    alu(4, RDX, 0x01);
+                    alu(0, RDX, RAX);
+                }
+                else {
+                    move(RDX, RAX);
+                }
+                
+                alu(0, RDX, RCX);
+                store8(reg(A), RDX);
+                
+                arithmetic(false);
+                break;
+                
+            // SUB, SBB, CMP add complement with inverted carry
+            case 2:
+            case 3:
+            case 7:
+                alu(6, RCX, 0xFF);
+                
+                if (destination == 3)
+                {
+                    movzx8(RDX, flags);
+                    alu(4, RDX, 0x01);
+                    alu(6, RDX, 0x01);
+                    alu(0, RDX, RAX);
+                }
+                else
+                {
+                    move(RDX, RAX);
+                    alu(0, RDX, 1);
+                }
+                
+                alu(0, RDX, RCX);
+                
+                if (destination != 7) {
+                    store8(reg(A), RDX);
+                }
+                
+                arithmetic(true);
+                break;
+                
+            // ANA sets auxiliary carry from bit 3 of operands
+            case 4:
+                move(R9, RAX);
+                alu(1, R9, RCX);
+                alu(4, R9, 0x08);
+                shift(4, R9, 1);
+                
+                alu(4, RAX, RCX);
+                store8(reg(A), RAX);
+                
+                movzx8(RAX, Mem(R8, 0, RAX));
+                alu(1, RAX, R9);
+                store8(flags, RAX);
+                break;
+                
+            // XRA, ORA
+            case 5:
+            case 6:
+                alu(destination == 5 ? 6 : 1, RAX, RCX);
+                store8(reg(A), RAX);
+                
+                movzx8(RAX, Mem(R8, 0, RAX));
+                store8(flags, RAX);
+                break;
+        }
+        
+        return true;
+    }
+    
+    // PUSH, CALL
+    if ((code & 0xCF) == 0xC5 || code == 0xCD || code == 0xDD || code == 0xED || code == 0xFD)
+    {
+        // Both bytes are checked before the first store
+        for (int32_t offset : { 1, 2 })
+        {
+            movzx16(RDX, sp);
+            alu(5, RDX, offset);
+            alu(4, RDX, 0xFFFF);
+            writable(index);
+        }
+        
+        for (int32_t offset : { 1, 2 })
+        {
+            bool high = offset == 1;
+            
+            if ((code & 0x0F) == 0x0D) {
+                move(R9, high ? operation.next >> 8 : operation.next & 0xFF);
+            }
+            else if (pair == 3) {
+                movzx8(R9, high ? reg(A) : flags);
+            }
+            else {
+                movzx8(R9, reg(pair * 2 + !high));
+            }
+            
+            movzx16(RDX, sp);
+            alu(5, RDX, offset);
+            alu(4, RDX, 0xFFFF);
+            store();
+        }
+        
+        alu16(5, sp, 2);
+        
+        if ((code & 0x0F) == 0x0D) {
+            store16(Mem(RDI, offsets.counter), operation.address);
+        }
+        
+        return true;
+    }
+    
+    // POP, RET
+    if ((code & 0xCF) == 0xC1 || code == 0xC9 || code == 0xD9)
+    {
+        movzx16(RDX, sp);
+        read(index);
+        move(R9, RAX);
+        
+        movzx16(RDX, sp);
+        alu(0, RDX, 1);
+        alu(4, RDX, 0xFFFF);
+        read(index);
+        
+        if ((code & 0x0F) == 0x09)
+        {
+            shift(4, RAX, 8);
+            alu(1, RAX, R9);
+            store16(Mem(RDI, offsets.counter), RAX);
+        }
+        else if (pair == 3)
+        {
+            store8(reg(A), RAX);
+            
+            // Fixed bits as Status(uint8_t) sets them
+            alu(4, R9, 0xD7);
+            alu(1, R9, 0x02);
+            store8(flags, R9);
+        }
+        else
+        {
+            store8(reg(pair * 2 + 0), RAX);
+            store8(reg(pair * 2 + 1), R9);
+        }
+        
+        alu16(0, sp, 2);
+        return true;
+    }
+    
+    switch (code)
+    {
+        // STAX
+        case 0x02:
+        case 0x12:
+            movzx8(R9, reg(A));
+            
+            readpair(pair);
+            writable(index);
+            store();
+            
+            return true;
+            
+        // LDAX
+        case 0x0A:
+        case 0x1A:
+            readpair(pair);
+            read(index);
+            store8(reg(A), RAX);
+            
+            return true;
+            
+        // SHLD
+        case 0x22:
+            move(RDX, operation.address);
+            writable(index);
+            move(RDX, (uint16_t) (operation.address + 1));
+            writable(index);
+            
+            movzx8(R9, reg(L));
+            move(RDX, operation.address);
+            store();
+            
+            movzx8(R9, reg(H));
+            move(RDX, (uint16_t) (operation.address + 1));
+            store();
+            
+            return true;
+            
+        // LHLD
+        case 0x2A:
+            move(RDX, operation.address);
+            read(index);
+            move(R9, RAX);
+            
+            move(RDX, (uint16_t) (operation.address + 1));
+            read(index);
+            
+            store8(reg(H), RAX);
+            store8(reg(L), R9);
+            
+            return true;
+            
+        // STA
+        case 0x32:
+            movzx8(R9, reg(A));
+            
+            move(RDX, operation.address);
+            writable(index);
+            store();
+            
+            return true;
+            
+        // LDA
+        case 0x3A:
+            move(RDX, operation.address);
+            read(index);
+            store8(reg(A), RAX);
+            
+            return true;
+            
+        // RLC
+        case 0x07:
+            movzx8(RAX, reg(A));
+            shift8(0, RAX, 1);
+            store8(reg(A), RAX);
+            alu(4, RAX, 0x01);
+            carry(RAX);
+            
+            return true;
+            
+        // RRC
+        case 0x0F:
+            movzx8(RAX, reg(A));
+            shift8(1, RAX, 1);
+            store8(reg(A), RAX);
+            shift(5, RAX, 7);
+            carry(RAX);
+            
+            return true;
+            
+        // RAL
+        case 0x17:
+            movzx8(RAX, reg(A));
+            movzx8(RDX, flags);
+            alu(4, RDX, 0x01);
+            alu(0, RAX, RAX);
+            alu(1, RAX, RDX);
+            store8(reg(A), RAX);
+            shift(5, RAX, 8);
+            carry(RAX);
+            
+            return true;
+            
+        // RAR
+        case 0x1F:
+            movzx8(RAX, reg(A));
+            move(R9, RAX);
+            alu(4, R9, 0x01);
+            movzx8(RDX, flags);
+            alu(4, RDX, 0x01);
+            shift(4, RDX, 7);
+            shift(5, RAX, 1);
+            alu(1, RAX, RDX);
+            store8(reg(A), RAX);
+            carry(R9);
+            
+            return true;
+            
+        // CMA
+        case 0x2F:
+            not8(reg(A));
+            return true;
+            
+        // STC
+        case 0x37:
+            alu8(1, flags, 0x01);
+            return true;
+            
+        // CMC
+        case 0x3F:
+            alu8(6, flags, 0x01);
+            return true;
+            
+        // XCHG, pairs are swapped as stored
+        case 0xEB:
+            movzx16(RAX, reg(2));
+            movzx16(RCX, reg(4));
+            store16(reg(2), RCX);
+            store16(reg(4), RAX);
+            
+            return true;
+            
+        // SPHL
+        case 0xF9:
+            readpair(2);
+            store16(sp, RDX);
+            
+            return true;
+            
+        // PCHL
+        case 0xE9:
+            readpair(2);
+            store16(Mem(RDI, offsets.counter), RDX);
+            
+            return true;
+            
+        // JMP
+        case 0xC3:
+        case 0xCB:
+            store16(Mem(RDI, offsets.counter), operation.address);
+            return true;
+    }
+    
+    // Jcc, odd conditions jump when status bit is set
+    if ((code & 0xC7) == 0xC2)
+    {
+        store16(Mem(RDI, offsets.counter), operation.address);
+        test8(flags, conditions[destination >> 1]);
+        
+        auto patch = skip(destination & 1 ? notequal : equal);
+        store16(Mem(RDI, offsets.counter), operation.next);
+        land(patch);
+        
+        return true;
+    }
+    
+    return false;
+}
+
+#pragma mark -
+#pragma mark Helpers
+
+// Byte at EDX to EAX
+void Jit::read(std::size_t index)
+{
+    high(RCX, RDX);
+    load(RAX, Mem(RSI, 0, RCX, 8));
+    test(RAX, RAX, true);
+    exit(equal, index);
+    
+    movzx8(RCX, RDX);
+    movzx8(RAX, Mem(RAX, 0, RCX));
+}
+
+// Page of EDX is direct and the byte is not decoded
+void Jit::writable(std::size_t index)
+{
+    high(RCX, RDX);
+    load(RAX, Mem(RSI, (int32_t) offsetof(Pages, write), RCX, 8));
+    test(RAX, RAX, true);
+    exit(equal, index);
+    
+    move(RCX, RDX);
+    shift(5, RCX, 6);
+    load(R10, Mem(R11, 0, RCX, 8));
+    bt(R10, RDX);
+    exit(below, index);
+}
+
+// R9 to EDX checked by writable()
+void Jit::store()
+{
+    high(RCX, RDX);
+    load(RAX, Mem(RSI, (int32_t) offsetof(Pages, write), RCX, 8));
+    movzx8(RCX, RDX);
+    store8(Mem(RAX, 0, RCX), R9);
+}
+
+// Register pair to EDX, high register is stored first
+void Jit::readpair(uint8_t index)
+{
+    movzx16(RDX, Mem(RDI, offsets.registers + index * 2));
+    swap16(RDX);
+}
+
+// DX to register pair
+void Jit::writepair(uint8_t index)
+{
+    swap16(RDX);
+    store16(Mem(RDI, offsets.registers + index * 2), RDX);
+}
+
+// Status from operands in EAX and ECX and result in EDX,
+// carries out of bits 3 and 7 are bits 4 and 8 of their sum
+void Jit::arithmetic(bool subtract)
+{
+    alu(6, RAX, RCX);
+    alu(6, RAX, RDX);
+    shift(5, RAX, 4);
+    alu(4, RAX, 0x1F);
+    
+    movzx8(RDX, RDX);
+    movzx8(RDX, Mem(R8, 0, RDX));
+    movzx8(RAX, Mem(R8, 256, RAX));
+    
+    if (subtract) {
+        alu(6, RAX, 0x01);
+    }
+    
+    alu(1, RDX, RAX);
+    store8(Mem(RDI, offsets.status), RDX);
+}
+
+// Carry flag from bit 0 of register, others are kept
+void Jit::carry(uint8_t reg)
+{
+    movzx8(RCX, Mem(RDI, offsets.status));
+    alu(4, RCX, 0xFE);
+    alu(1, RCX, (Reg) reg);
+    store8(Mem(RDI, offsets.status), RCX);
+}
+
+#pragma mark -
+#pragma mark Assembler
+
+Jit::Mem::Mem(Reg base, int32_t disp, Reg index, uint8_t scale) : base(base), disp(disp), index(index), scale(scale)
+{
+    
+}
+
+void Jit::emit(uint8_t byte)
+{
+    output.push_back(byte);
+}
+
+void Jit::emit32(uint32_t value)
+{
+    for (int shift = 0; shift < 32; shift += 8) {
+        emit((uint8_t) (value >> shift));
+    }
+}
+
+void Jit::emit64(uint64_t value)
+{
+    emit32((uint32_t) value);
+    emit32((uint32_t) (value >> 32));
+}
+
+void Jit::rex(bool wide, uint8_t reg, uint8_t index, uint8_t base, bool force)
+{
+    uint8_t prefix = 0x40 | wide << 3 | (reg >> 3) << 2 | (index >> 3) << 1 | base >> 3;
+    
+    if (prefix != 0x40 || force) {
+        emit(prefix);
+    }
+}
+
+// Byte registers 4-7 are SPL-DIL with prefix and AH-BH without
+static bool legacy(uint8_t reg)
+{
+    return reg >= 4 && reg < 8;
+}
+
+void Jit::operand(uint8_t reg, const Mem & mem)
+{
+    uint8_t base = mem.base & 0x07;
+    uint8_t mode = 2;
+    
+    // RBP and R13 have no form without displacement
+    if (mem.disp == 0 && base != 5) {
+        mode = 0;
+    }
+    else if (mem.disp >= -128 && mem.disp < 128) {
+        mode = 1;
+    }
+    
+    if (mem.index != NONE || base == 4)
+    {
+        uint8_t index = mem.index == NONE ? 4 : mem.index & 0x07;
+        uint8_t scale = mem.scale == 8 ? 3 : mem.scale == 4 ? 2 : mem.scale == 2 ? 1 : 0;
+        
+        emit(mode << 6 | (reg & 0x07) << 3 | 4);
+        emit(scale << 6 | index << 3 | base);
+    }
+    else {
+        emit(mode << 6 | (reg & 0x07) << 3 | base);
+    }
+    
+    if (mode == 1) {
+        emit((uint8_t) mem.disp);
+    }
+    
+    if (mode == 2) {
+        emit32((uint32_t) mem.disp);
+    }
+}
+
+void Jit::op(std::initializer_list<uint8_t> opcode, uint8_t reg, const Mem & mem, bool wide, bool bytes)
+{
+    rex(wide, reg, mem.index == NONE ? 0 : mem.index, mem.base, bytes && legacy(reg));
+    
+    for (auto byte : opcode) {
+        emit(byte);
+    }
+    
+    operand(reg, mem);
+}
+
+void Jit::op(std::initializer_list<uint8_t> opcode, uint8_t reg, Reg rm, bool wide, bool bytes)
+{
+    rex(wide, reg, 0, rm, bytes && (legacy(reg) || legacy(rm)));
+    
+    for (auto byte : opcode) {
+        emit(byte);
+    }
+    
+    emit(0xC0 | (reg & 0x07) << 3 | (rm & 0x07));
+}
+
+void Jit::movzx8(Reg reg, const Mem & mem)
+{
+    op({ 0x0F, 0xB6 }, reg, mem);
+}
+
+void Jit::movzx16(Reg reg, const Mem & mem)
+{
+    op({ 0x0F, 0xB7 }, reg, mem);
+}
+
+void Jit::movzx8(Reg reg, Reg source)
+{
+    op({ 0x0F, 0xB6 }, reg, source, false, true);
+}
+
+// Bits 8-15 of RAX-RBX, no prefix is allowed
+void Jit::high(Reg reg, Reg source)
+{
+    emit(0x0F);
+    emit(0xB6);
+    emit(0xC0 | reg << 3 | (source + 4));
+}
+
+void Jit::load(Reg reg, const Mem & mem)
+{
+    op({ 0x8B }, reg, mem, true);
+}
+
+void Jit::store8(const Mem & mem, Reg reg)
+{
+    op({ 0x88 }, reg, mem, false, true);
+}
+
+void Jit::store16(const Mem & mem, Reg reg)
+{
+    emit(0x66);
+    op({ 0x89 }, reg, mem);
+}
+
+void Jit::store8(const Mem & mem, uint8_t value)
+{
+    op({ 0xC6 }, 0, mem);
+    emit(value);
+}
+
+void Jit::store16(const Mem & mem, uint16_t value)
+{
+    emit(0x66);
+    op({ 0xC7 }, 0, mem);
+    
+    emit((uint8_t) value);
+    emit((uint8_t) (value >> 8));
+}
+
+void Jit::move(Reg reg, uint32_t value)
+{
+    rex(false, 0, 0, reg);
+    emit(0xB8 | (reg & 0x07));
+    emit32(value);
+}
+
+void Jit::move(Reg reg, const void * pointer)
+{
+    rex(true, 0, 0, reg);
+    emit(0xB8 | (reg & 0x07));
+    emit64((uint64_t) pointer);
+}
+
+void Jit::move(Reg reg, Reg source)
+{
+    op({ 0x89 }, source, reg);
+}
+
+void Jit::alu(uint8_t extension, Reg reg, Reg source)
+{
+    op({ (uint8_t) (extension << 3 | 0x01) }, source, reg);
+}
+
+void Jit::alu(uint8_t extension, Reg reg, int32_t value)
+{
+    if (value >= -128 && value < 128)
+    {
+        op({ 0x83 }, extension, reg);
+        emit((uint8_t) value);
+        
+        return;
+    }
+    
+    op({ 0x81 }, extension, reg);
+    emit32((uint32_t) value);
+}
+
+void Jit::alu8(uint8_t extension, const Mem & mem, uint8_t value)
+{
+    op({ 0x80 }, extension, mem);
+    emit(value);
+}
+
+void Jit::alu16(uint8_t extension, const Mem & mem, uint8_t value)
+{
+    emit(0x66);
+    op({ 0x83 }, extension, mem);
+    emit(value);
+}
+
+void Jit::shift(uint8_t extension, Reg reg, uint8_t count)
+{
+    op({ 0xC1 }, extension, reg);
+    emit(count);
+}
+
+void Jit::shift8(uint8_t extension, Reg reg, uint8_t count)
+{
+    op({ 0xC0 }, extension, reg, false, true);
+    emit(count);
+}
+
+// Byte order of 16 bit register, ROL by 8
+void Jit::swap16(Reg reg)
+{
+    emit(0x66);
+    shift(0, reg, 8);
+}
+
+void Jit::test(Reg reg, Reg source, bool wide)
+{
+    op({ 0x85 }, source, reg, wide);
+}
+
+void Jit::test8(const Mem & mem, uint8_t value)
+{
+    op({ 0xF6 }, 0, mem);
+    emit(value);
+}
+
+void Jit::not8(const Mem & mem)
+{
+    op({ 0xF6 }, 2, mem);
+}
+
+void Jit::bt(Reg reg, Reg bit)
+{
+    op({ 0x0F, 0xA3 }, bit, reg, true);
+}
+
+void Jit::set(uint8_t condition, Reg reg)
+{
+    op({ 0x0F, (uint8_t) (0x90 | condition) }, 0, reg, false, true);
+}
+
+void Jit::exit(uint8_t condition, std::size_t index)
+{
+    emit(0x0F);
+    emit(0x80 | condition);
+    
+    exits.push_back({ output.size(), index });
+    emit32(0);
+}
+
+std::size_t Jit::skip(uint8_t condition)
+{
+    emit(0x70 | condition);
+    emit(0x00);
+    
+    return output.size() - 1;
+}
+
+void Jit::land(std::size_t patch)
+{
+    output[patch] = (uint8_t) (output.size() - (patch + 1));
+}
+
+void Jit::ret()
+{
+    emit(0xC3);
+}
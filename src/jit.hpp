@@ -0,0 +1,214 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JIT_HPP
+#define JIT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+#include "blockcache.hpp"
+
+// Translator of hot cached blocks to x86-64 code, built with
+// JIT on Linux. Host code works on processor state in place
+// and returns to interpreter at the first operation it can't
+// complete: not translated operation, memory without direct
+// access or store to decoded bytes
+class Jit
+{
+public:
+    
+    struct Statistics
+    {
+        uint64_t translated = 0; // Blocks with host code
+        uint64_t operations = 0; // Operations translated
+        uint64_t resets     = 0; // Buffer filled and started over
+    };
+    
+private:
+    
+    // Runs of block before it is translated
+    static const uint16_t threshold = 16;
+    
+    // Host code of all blocks, cache is cleared when it's full
+    static const std::size_t capacity = 4 << 20;
+    
+    uint8_t * buffer = nullptr;
+    std::size_t used = 0;
+    
+    // Processor state relative to Cpu pointer
+    struct Offsets
+    {
+        int32_t registers = 0;
+        int32_t status    = 0;
+        int32_t stack     = 0;
+        int32_t counter   = 0;
+        int32_t opcode    = 0;
+        int32_t pages     = 0;
+    };
+    
+    Offsets offsets;
+    
+    // Copy of Status tables: szp, then add
+    uint8_t tables[256 + 32] {};
+    
+    // Decoded bytes of cache, bit per address
+    const uint64_t * bits = nullptr;
+    
+    BlockCache & cache;
+    
+    Statistics counters;
+    
+    // Host code of block being translated
+    std::vector<uint8_t> output;
+    
+    // Exit before operation, jumps are patched at the end
+    struct Exit
+    {
+        std::size_t patch;
+        std::size_t index;
+    };
+    
+    std::vector<Exit> exits;
+    
+    Native translate(const Block & block);
+    
+    // Copy host code of block to buffer
+    bool install(uint8_t * native);
+    
+    // Emit operation, false when it's not translated
+    bool operation(const Block & block, std::size_t index);
+    
+    // Memory access through direct pages, address in EDX
+    void read(std::size_t index);
+    void writable(std::size_t index);
+    void store();
+    
+    void readpair (uint8_t index);
+    void writepair(uint8_t index);
+    
+    void arithmetic(bool subtract);
+    void carry(uint8_t reg);
+    
+// Assembler
+private:
+    
+    enum Reg : uint8_t
+    {
+        RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+        R8,  R9,  R10, R11, R12, R13, R14, R15,
+        NONE = 0xFF
+    };
+    
+    // [base + index × scale + displacement]
+    struct Mem
+    {
+        Reg base;
+        int32_t disp = 0;
+        Reg index = NONE;
+        uint8_t scale = 1;
+        
+        Mem(Reg base, int32_t disp = 0, Reg index = NONE, uint8_t scale = 1);
+    };
+    
+    void emit(uint8_t byte);
+    void emit32(uint32_t value);
+    void emit64(uint64_t value);
+    
+    // Prefix is forced for byte registers SPL-DIL
+    void rex(bool wide, uint8_t reg, uint8_t index, uint8_t base, bool force = false);
+    void operand(uint8_t reg, const Mem & mem);
+    
+    // Opcode with register and memory or register operand
+    void op(std::initializer_list<uint8_t> opcode, uint8_t reg, const Mem & mem, bool wide = false, bool bytes = false);
+    void op(std::initializer_list<uint8_t> opcode, uint8_t reg, Reg rm, bool wide = false, bool bytes = false);
+    
+    void movzx8 (Reg reg, const Mem & mem);
+    void movzx16(Reg reg, const Mem & mem);
+    void movzx8 (Reg reg, Reg source);
+    void high   (Reg reg, Reg source);
+    void load   (Reg reg, const Mem & mem);
+    void store8 (const Mem & mem, Reg reg);
+    void store16(const Mem & mem, Reg reg);
+    void store8 (const Mem & mem, uint8_t value);
+    void store16(const Mem & mem, uint16_t value);
+    void move   (Reg reg, uint32_t value);
+    void move   (Reg reg, const void * pointer);
+    void move   (Reg reg, Reg source);
+    
+    // ALU extension: 0 ADD, 1 OR, 4 AND, 5 SUB, 6 XOR, 7 CMP
+    void alu    (uint8_t extension, Reg reg, Reg source);
+    void alu    (uint8_t extension, Reg reg, int32_t value);
+    void alu8   (uint8_t extension, const Mem & mem, uint8_t value);
+    void alu16  (uint8_t extension, const Mem & mem, uint8_t value);
+    
+    // Shift extension: 0 ROL, 1 ROR, 4 SHL, 5 SHR
+    void shift  (uint8_t extension, Reg reg, uint8_t count);
+    void shift8 (uint8_t extension, Reg reg, uint8_t count);
+    void swap16 (Reg reg);
+    
+    void test   (Reg reg, Reg source, bool wide = false);
+    void test8  (const Mem & mem, uint8_t value);
+    void not8   (const Mem & mem);
+    void bt     (Reg reg, Reg bit);
+    void set    (uint8_t condition, Reg reg);
+    
+    // Conditional jump to exit before operation
+    void exit   (uint8_t condition, std::size_t index);
+    
+    // Short forward jump, returns position to patch
+    std::size_t skip(uint8_t condition);
+    void land(std::size_t patch);
+    
+    void ret();
+    
+    // Buffer and tables, offsets are taken from processor
+    Jit(BlockCache & cache);
+    
+public:
+    
+    template <class Processor>
+    Jit(const Processor & cpu, BlockCache & cache);
+    
+    ~Jit();
+    
+    Jit(const Jit &) = delete;
+    Jit & operator= (const Jit &) = delete;
+    
+    // Count run of block and translate it when it's hot
+    void heat(const Block & block);
+    
+    const Statistics & statistics() const;
+};
+
+// Native code works on processor fields in place
+template <class Processor>
+Jit::Jit(const Processor & cpu, BlockCache & cache) : Jit(cache)
+{
+    auto base = (const uint8_t *) &cpu;
+    
+    offsets.registers = (int32_t) (cpu.registers - base);
+    offsets.status    = (int32_t) (&cpu.status.status - base);
+    offsets.stack     = (int32_t) ((const uint8_t *) &cpu.stack   - base);
+    offsets.counter   = (int32_t) ((const uint8_t *) &cpu.counter - base);
+    offsets.opcode    = (int32_t) (&cpu.opcode - base);
+    offsets.pages     = (int32_t) ((const uint8_t *) &cpu.pages   - base);
+}
+
+#endif /* JIT_HPP */
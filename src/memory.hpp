@@ -0,0 +1,42 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MEMORY_HPP
+#define MEMORY_HPP
+
+#include <cstdint>
+
+#include "IO.hpp"
+
+// Host pointers to 256 byte pages of address space
+// Page is accessed through IO read/write when pointer is nullptr
+struct Pages
+{
+    const uint8_t * read  [256] {};
+          uint8_t * write [256] {};
+};
+
+// Memory which lets CPU access host storage directly.
+// Only pages without pointers (memory mapped IO) cost a virtual call
+class Memory : public IO<uint16_t>
+{
+public:
+    // Page table, CPU keeps reference while connected
+    virtual const Pages & pages() const = 0;
+};
+
+#endif /* MEMORY_HPP */
@@ -0,0 +1,202 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include "memorymap.hpp"
+
+MemoryMap::MemoryMap()
+{
+    std::memset(openbus, 0xFF, sizeof(openbus));
+    unmap(0x0000, 64 * 1024);
+}
+
+#pragma mark -
+#pragma mark Pages
+
+// Index of page starting at address
+std::size_t MemoryMap::first(uint16_t address)
+{
+    assert((address & 0xFF) == 0);
+    return address >> 8;
+}
+
+// Number of pages in region
+std::size_t MemoryMap::count(std::size_t size)
+{
+    assert((size & 0xFF) == 0);
+    return size >> 8;
+}
+
+#pragma mark -
+#pragma mark Mapping
+
+void MemoryMap::ram(uint16_t address, uint8_t * data, std::size_t size)
+{
+    auto page = first(address);
+    auto total = count(size);
+    
+    assert(page + total <= 256);
+    
+    for (std::size_t i = 0; i < total; i++, page++)
+    {        
+        table.read  [page] = data + (i << 8);
+        table.write [page] = data + (i << 8);
+        
+        devices[page] = nullptr;
+    }
+}
+
+void MemoryMap::rom(uint16_t address, const uint8_t * data, std::size_t size)
+{
+    auto page = first(address);
+    auto total = count(size);
+    
+    assert(page + total <= 256);
+    
+    for (std::size_t i = 0; i < total; i++, page++)
+    {        
+        table.read  [page] = data + (i << 8);
+        table.write [page] = sink;
+        
+        devices[page] = nullptr;
+    }
+}
+
+void MemoryMap::device(uint16_t address, std::size_t size, std::shared_ptr<IO<uint16_t>> device)
+{
+    auto page = first(address);
+    auto total = count(size);
+    
+    assert(page + total <= 256);
+    
+    for (std::size_t i = 0; i < total; i++, page++)
+    {        
+        table.read  [page] = nullptr;
+        table.write [page] = nullptr;
+        
+        devices[page] = device;
+    }
+}
+
+void MemoryMap::unmap(uint16_t address, std::size_t size)
+{
+    auto page = first(address);
+    auto total = count(size);
+    
+    assert(page + total <= 256);
+    
+    for (std::size_t i = 0; i < total; i++, page++)
+    {        
+        table.read  [page] = openbus;
+        table.write [page] = sink;
+        
+        devices[page] = nullptr;
+    }
+}
+
+#pragma mark -
+#pragma mark Banks
+
+std::size_t MemoryMap::window(uint16_t address, std::size_t size, std::vector<uint8_t *> banks)
+{
+    assert(!banks.empty());
+    
+    windows.push_back({ address, size, 0, std::move(banks) });
+    select(windows.size() - 1, 0);
+    
+    return windows.size() - 1;
+}
+
+void MemoryMap::select(std::size_t window, std::size_t bank)
+{
+    auto & region = windows[window];
+    
+    assert(bank < region.banks.size());
+    
+    region.selected = bank;
+    ram(region.address, region.banks[bank], region.size);
+}
+
+std::size_t MemoryMap::selected(std::size_t window) const
+{
+    return windows[window].selected;
+}
+
+std::size_t MemoryMap::banks(std::size_t window) const
+{
+    return windows[window].banks.size();
+}
+
+#pragma mark -
+#pragma mark IO
+
+uint8_t MemoryMap::read(uint16_t address) const
+{
+    auto page = table.read[address >> 8];
+    
+    if (page != nullptr) {
+        return page[address & 0xFF];
+    }
+    
+    return devices[address >> 8] -> read(address);
+}
+
+void MemoryMap::write(uint16_t address, uint8_t data)
+{
+    auto page = table.write[address >> 8];
+    
+    if (page != nullptr) {
+        page[address & 0xFF] = data;
+        return;
+    }
+    
+    devices[address >> 8] -> write(address, data);
+}
+
+const Pages & MemoryMap::pages() const
+{
+    return table;
+}
+
+#pragma mark -
+#pragma mark Bank switch
+
+BankSwitch::BankSwitch(std::shared_ptr<MemoryMap> map, std::size_t window, uint8_t port)
+    : map(map), window(window), port(port)
+{
+    
+}
+
+uint8_t BankSwitch::read(uint8_t port) const
+{
+    if (port != this -> port) {
+        return 0x00;
+    }
+    
+    return map -> selected(window) & 0xFF;
+}
+
+void BankSwitch::write(uint8_t port, uint8_t data)
+{
+    if (port != this -> port) {
+        return;
+    }
+    
+    map -> select(window, data % map -> banks(window));
+}
@@ -0,0 +1,114 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MEMORYMAP_HPP
+#define MEMORYMAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "memory.hpp"
+
+// Address space split into 256 pages of 256 bytes.
+// Every page is RAM, ROM, unmapped or handled by device.
+// Address and size of every region must be aligned to page.
+class MemoryMap : public Memory
+{
+private:
+    
+    // Page pointers used by CPU
+    Pages table;
+    
+    // Handlers of memory mapped IO pages
+    std::shared_ptr<IO<uint16_t>> devices[256];
+    
+    // Writes to ROM and unmapped pages land here
+    uint8_t sink[256] {};
+    
+    // Unmapped pages read as open bus
+    uint8_t openbus[256] {};
+    
+    // Region switched between banks of host storage
+    struct Window
+    {
+        uint16_t address;
+        std::size_t size;
+        std::size_t selected;
+        
+        std::vector<uint8_t *> banks;
+    };
+    
+    std::vector<Window> windows;
+    
+    static std::size_t first (uint16_t address);
+    static std::size_t count (std::size_t size);
+    
+public:
+    
+    // Whole address space is unmapped
+    MemoryMap();
+    
+    // Read and write host storage, storage is not owned
+    void ram (uint16_t address, uint8_t * data, std::size_t size);
+    
+    // Read host storage, writes are ignored
+    void rom (uint16_t address, const uint8_t * data, std::size_t size);
+    
+    // Forward every access to device
+    void device (uint16_t address, std::size_t size, std::shared_ptr<IO<uint16_t>> device);
+    
+    // Read 0xFF, writes are ignored
+    void unmap (uint16_t address, std::size_t size);
+    
+    // Create banked region with first bank selected, return window index
+    std::size_t window (uint16_t address, std::size_t size, std::vector<uint8_t *> banks);
+    
+    // Map bank into window. No memory is copied,
+    // only page pointers of window are rewritten
+    void select (std::size_t window, std::size_t bank);
+    
+    std::size_t selected (std::size_t window) const;
+    std::size_t banks    (std::size_t window) const;
+    
+public:
+    
+    virtual uint8_t read (uint16_t address) const override;
+    virtual void write (uint16_t address, uint8_t data) override;
+    
+    virtual const Pages & pages() const override;
+};
+
+// Port device switching banks of memory map window.
+// Value written to port selects bank, reading returns selected one
+class BankSwitch : public IO<uint8_t>
+{
+private:
+    std::shared_ptr<MemoryMap> map;
+    
+    std::size_t window;
+    uint8_t port;
+    
+public:
+    BankSwitch(std::shared_ptr<MemoryMap> map, std::size_t window, uint8_t port);
+    
+    virtual uint8_t read (uint8_t port) const override;
+    virtual void write (uint8_t port, uint8_t data) override;
+};
+
+#endif /* MEMORYMAP_HPP */
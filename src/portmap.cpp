@@ -0,0 +1,90 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+
+#include "portmap.hpp"
+
+PortMap::PortMap()
+{
+    detach(0x00, 256);
+}
+
+#pragma mark -
+#pragma mark Mapping
+
+void PortMap::attach(uint8_t port, std::shared_ptr<IO<uint8_t>> device, std::size_t count)
+{
+    assert(device != nullptr && port + count <= 256);
+    
+    for (std::size_t i = 0; i < count; i++) {
+        devices[port + i] = device;
+    }
+    
+    if (std::find(attached.begin(), attached.end(), device) == attached.end()) {
+        attached.push_back(device);
+    }
+}
+
+void PortMap::detach(uint8_t port, std::size_t count)
+{
+    assert(port + count <= 256);
+    
+    for (std::size_t i = 0; i < count; i++) {
+        devices[port + i] = DefaultIO<uint8_t>::instance();
+    }
+    
+    // Devices left without ports
+    attached.erase(std::remove_if(attached.begin(), attached.end(), [this] (const std::shared_ptr<IO<uint8_t>> & device)
+    {
+        return std::find(std::begin(devices), std::end(devices), device) == std::end(devices);
+    }),
+    attached.end());
+}
+
+#pragma mark -
+#pragma mark IO
+
+uint8_t PortMap::read(uint8_t port) const
+{
+    return devices[port] -> read(port);
+}
+
+void PortMap::write(uint8_t port, uint8_t data)
+{
+    devices[port] -> write(port, data);
+}
+
+void PortMap::enableInterrupt()
+{
+    for (auto & device : attached) {
+        device -> enableInterrupt();
+    }
+}
+
+void PortMap::disableInterrupt()
+{
+    for (auto & device : attached) {
+        device -> disableInterrupt();
+    }
+}
+
+bool PortMap::stable(uint8_t port) const
+{
+    return devices[port] -> stable(port);
+}
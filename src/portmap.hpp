@@ -0,0 +1,65 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PORTMAP_HPP
+#define PORTMAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "IO.hpp"
+
+// Port address space shared by several devices, e.g. Console
+// and BankSwitch. Every port is handled by one device, free
+// ports read 0x00 and ignore writes
+class PortMap : public IO<uint8_t>
+{
+private:
+    
+    // Handlers by port, free ports point to stub
+    std::shared_ptr<IO<uint8_t>> devices[256];
+    
+    // Every attached device once, in order of attaching
+    std::vector<std::shared_ptr<IO<uint8_t>>> attached;
+    
+public:
+    
+    // Every port is free
+    PortMap();
+    
+    // Forward ports from port to port + count - 1 to device,
+    // device receives port number as CPU sent it
+    void attach(uint8_t port, std::shared_ptr<IO<uint8_t>> device, std::size_t count = 1);
+    
+    // Free ports, device stays attached while it has any
+    void detach(uint8_t port, std::size_t count = 1);
+    
+public:
+    
+    virtual uint8_t read (uint8_t port) const override;
+    virtual void write (uint8_t port, uint8_t data) override;
+    
+    // Told to every attached device
+    virtual void enableInterrupt () override;
+    virtual void disableInterrupt() override;
+    
+    virtual bool stable(uint8_t port) const override;
+};
+
+#endif /* PORTMAP_HPP */
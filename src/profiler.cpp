@@ -0,0 +1,235 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+#include "cpu.hpp"
+#include "profiler.hpp"
+
+const Profiler::Counter & Profiler::opcode(uint8_t opcode) const
+{
+    return opcodes[opcode];
+}
+
+const Profiler::Counter & Profiler::address(uint16_t address) const
+{
+    return addresses[address];
+}
+
+void Profiler::clear()
+{
+    for (auto & counter : opcodes) {
+        counter = Counter();
+    }
+    
+    for (auto & counter : addresses) {
+        counter = Counter();
+    }
+    
+    calls.clear();
+    returns.clear();
+}
+
+#pragma mark -
+#pragma mark Edges
+
+void Profiler::Edges::grow()
+{
+    auto edges = list();
+    
+    slots.assign(slots.size() * 2, Edge());
+    
+    std::size_t mask = slots.size() - 1;
+    
+    for (auto & edge : edges)
+    {
+        std::size_t index = home(edge.first);
+        
+        while (slots[index].count != 0) {
+            index = (index + 1) & mask;
+        }
+        
+        slots[index].key   = edge.first;
+        slots[index].count = edge.second;
+    }
+}
+
+void Profiler::Edges::clear()
+{
+    slots.assign(slots.size(), Edge());
+    used = 0;
+}
+
+std::vector<std::pair<uint32_t, uint64_t>> Profiler::Edges::list() const
+{
+    std::vector<std::pair<uint32_t, uint64_t>> edges;
+    
+    for (auto & edge : slots)
+    {
+        if (edge.count != 0) {
+            edges.emplace_back(edge.key, edge.count);
+        }
+    }
+    
+    return edges;
+}
+
+#pragma mark -
+#pragma mark Report
+
+void Profiler::report(std::ostream & out, std::size_t top) const
+{
+    uint64_t total = 0;
+    
+    for (auto & counter : opcodes) {
+        total += counter.cycles;
+    }
+    
+    auto percent = [total](uint64_t cycles) {
+        return total ? 100.0 * cycles / total : 0.0;
+    };
+    
+    auto flags = out.flags();
+    out << std::fixed << std::setprecision(2);
+    
+    // Operations by cycles
+    
+    std::vector<std::size_t> order(256);
+    
+    for (std::size_t index = 0; index < order.size(); index++) {
+        order[index] = index;
+    }
+    
+    std::sort(order.begin(), order.end(), [this](std::size_t x, std::size_t y) {
+        return opcodes[x].cycles > opcodes[y].cycles;
+    });
+    
+    out << "Operations" << std::endl;
+    
+    for (std::size_t index = 0; index < std::min(top, order.size()); index++)
+    {
+        auto & counter = opcodes[order[index]];
+        
+        if (counter.executions == 0) {
+            break;
+        }
+        
+        out << "  " << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << order[index];
+        out << std::dec << std::setfill(' ') << " " << std::left << std::setw(5) << Cpu::commands[order[index]].name << std::right;
+        out << std::setw(16) << counter.executions << std::setw(16) << counter.cycles;
+        out << std::setw(8)  << percent(counter.cycles) << "%" << std::endl;
+    }
+    
+    // Addresses by cycles
+    
+    order.resize(0x10000);
+    
+    for (std::size_t index = 0; index < order.size(); index++) {
+        order[index] = index;
+    }
+    
+    std::partial_sort(order.begin(), order.begin() + std::min(top, order.size()), order.end(), [this](std::size_t x, std::size_t y) {
+        return addresses[x].cycles > addresses[y].cycles;
+    });
+    
+    out << "Addresses" << std::endl;
+    
+    for (std::size_t index = 0; index < std::min(top, order.size()); index++)
+    {
+        auto & counter = addresses[order[index]];
+        
+        if (counter.executions == 0) {
+            break;
+        }
+        
+        out << "  " << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << order[index];
+        out << std::dec << std::setfill(' ') << std::setw(20) << counter.executions << std::setw(16) << counter.cycles;
+        out << std::setw(8) << percent(counter.cycles) << "%" << std::endl;
+    }
+    
+    // Call graph edges by count
+    
+    auto edges = calls.list();
+    
+    std::sort(edges.begin(), edges.end(), [](const std::pair<uint32_t, uint64_t> & x, const std::pair<uint32_t, uint64_t> & y) {
+        return x.second > y.second;
+    });
+    
+    out << "Calls" << std::endl;
+    
+    for (std::size_t index = 0; index < std::min(top, edges.size()); index++)
+    {
+        out << "  " << std::hex << std::uppercase << std::setfill('0');
+        out << std::setw(4) << (edges[index].first >> 16) << " -> " << std::setw(4) << (edges[index].first & 0xFFFF);
+        out << std::dec << std::setfill(' ') << std::setw(16) << edges[index].second << std::endl;
+    }
+    
+    out.flags(flags);
+}
+
+#pragma mark -
+#pragma mark Dump
+
+bool Profiler::dump(const std::string & path) const
+{
+    std::ofstream file(path, std::ios::out | std::ios::binary);
+    
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    auto put = [&file](const void * data, std::size_t size) {
+        file.write((const char *) data, (std::streamsize) size);
+    };
+    
+    auto edges = [&put](const std::vector<std::pair<uint32_t, uint64_t>> & edges)
+    {
+        uint64_t count = edges.size();
+        put(&count, sizeof(count));
+        
+        for (auto & edge : edges)
+        {
+            uint16_t source = edge.first >> 16;
+            uint16_t target = edge.first & 0xFFFF;
+            
+            put(&source, sizeof(source));
+            put(&target, sizeof(target));
+            put(&edge.second, sizeof(edge.second));
+        }
+    };
+    
+    put("8080PROF", 8);
+    
+    for (auto & counter : opcodes)
+    {
+        put(&counter.executions, sizeof(counter.executions));
+        put(&counter.cycles, sizeof(counter.cycles));
+    }
+    
+    for (auto & counter : addresses)
+    {
+        put(&counter.executions, sizeof(counter.executions));
+        put(&counter.cycles, sizeof(counter.cycles));
+    }
+    
+    edges(calls.list());
+    edges(returns.list());
+    
+    return file.good();
+}
@@ -0,0 +1,164 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Executions and cycles per operation code, per address
+// and per call graph edge. Filled by Cpu built with PROFILE
+class Profiler
+{
+public:
+    
+    struct Counter
+    {
+        uint64_t executions = 0;
+        uint64_t cycles     = 0;
+    };
+    
+private:
+    
+    // Counts keyed by source << 16 | target in open addressing
+    // table, slot with zero count is free
+    class Edges
+    {
+    private:
+        
+        struct Edge
+        {
+            uint32_t key   = 0;
+            uint64_t count = 0;
+        };
+        
+        // Power of two, at most half used
+        std::vector<Edge> slots = std::vector<Edge>(1024);
+        std::size_t used = 0;
+        
+        std::size_t home(uint32_t key) const;
+        void grow();
+        
+    public:
+        
+        void bump(uint32_t key);
+        void clear();
+        
+        // Key and count of every edge
+        std::vector<std::pair<uint32_t, uint64_t>> list() const;
+    };
+    
+    Counter opcodes[256];
+    
+    // Indexed by address of operation
+    Counter addresses[0x10000];
+    
+    // Taken calls and returns
+    Edges calls;
+    Edges returns;
+    
+public:
+    
+    void record(uint16_t counter, uint8_t opcode, uint8_t cycles);
+    
+    // Operation executed a number of times at once
+    void record(uint16_t counter, uint8_t opcode, uint64_t executions, uint64_t cycles);
+    
+    void call (uint16_t source, uint16_t target);
+    void ret  (uint16_t source, uint16_t target);
+    
+    const Counter & opcode (uint8_t opcode) const;
+    const Counter & address(uint16_t address) const;
+    
+    // Most expensive operations, addresses and calls
+    void report(std::ostream & out, std::size_t top = 20) const;
+    
+    // Flat binary file, host byte order:
+    //   "8080PROF"
+    //   256   × { executions, cycles }         uint64_t
+    //   65536 × { executions, cycles }         uint64_t
+    //   calls,   then count × { source, target, count }
+    //   returns, then count × { source, target, count }
+    //   count uint64_t, source and target uint16_t, count uint64_t
+    bool dump(const std::string & path) const;
+    
+    void clear();
+};
+
+inline void Profiler::record(uint16_t counter, uint8_t opcode, uint8_t cycles)
+{
+    opcodes[opcode].executions++;
+    opcodes[opcode].cycles += cycles;
+    
+    addresses[counter].executions++;
+    addresses[counter].cycles += cycles;
+}
+
+inline void Profiler::record(uint16_t counter, uint8_t opcode, uint64_t executions, uint64_t cycles)
+{
+    opcodes[opcode].executions += executions;
+    opcodes[opcode].cycles += cycles;
+    
+    addresses[counter].executions += executions;
+    addresses[counter].cycles += cycles;
+}
+
+inline void Profiler::call(uint16_t source, uint16_t target)
+{
+    calls.bump((uint32_t) source << 16 | target);
+}
+
+inline void Profiler::ret(uint16_t source, uint16_t target)
+{
+    returns.bump((uint32_t) source << 16 | target);
+}
+
+inline std::size_t Profiler::Edges::home(uint32_t key) const
+{
+    return (std::size_t) ((key * 0x9E3779B97F4A7C15ULL) >> 32) & (slots.size() - 1);
+}
+
+inline void Profiler::Edges::bump(uint32_t key)
+{
+    std::size_t mask = slots.size() - 1;
+    std::size_t index = home(key);
+    
+    while (slots[index].count != 0)
+    {
+        if (slots[index].key == key)
+        {
+            slots[index].count++;
+            return;
+        }
+        
+        index = (index + 1) & mask;
+    }
+    
+    slots[index].key   = key;
+    slots[index].count = 1;
+    
+    if (++used * 2 > slots.size()) {
+        grow();
+    }
+}
+
+#endif /* PROFILER_HPP */
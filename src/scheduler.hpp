@@ -0,0 +1,214 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "cpufwd.hpp"
+
+// Callbacks due at absolute clock, kept in min-heap.
+// Processor runs straight up to the earliest of them
+template <class Processor>
+class BasicScheduler
+{
+public:
+    using Callback = std::function<void(Processor &)>;
+    
+private:
+    
+    struct Event
+    {
+        uint64_t clock;
+        uint64_t id;     // Events due at the same clock fire in order
+    };
+    
+    // Earliest event on top
+    std::vector<Event> heap;
+    
+    // Callbacks by id, cancelled events are missing
+    std::unordered_map<uint64_t, Callback> callbacks;
+    
+    uint64_t ids = 0;
+    
+    // Clock of heap top
+    uint64_t deadline = UINT64_MAX;
+    
+    // Event was scheduled before deadline
+    // since the last call of limit()
+    bool earlier = false;
+    
+    static bool later(const Event & first, const Event & second);
+    
+    // Remove cancelled events from top
+    void prune();
+    
+    std::size_t fire(Processor & cpu, uint64_t clock);
+    
+public:
+    
+    // Returns id of event
+    uint64_t schedule(uint64_t clock, Callback callback);
+    
+    // False when event has fired or was cancelled
+    bool cancel(uint64_t id);
+    
+    void clear();
+    
+    // Clock of the earliest event or UINT64_MAX
+    uint64_t next() const;
+    
+    // Deadline moved closer by schedule(). Processor
+    // running up to next() has to stop earlier
+    bool hastened() const;
+    
+    // Take next() as the limit of execution
+    uint64_t limit();
+    
+    bool empty() const;
+    
+    // Fire events due at clock, including events
+    // scheduled by callbacks. Returns number of fired
+    std::size_t dispatch(Processor & cpu, uint64_t clock);
+};
+
+using Scheduler = BasicScheduler<Cpu>;
+
+template <class Processor>
+inline uint64_t BasicScheduler<Processor>::next() const
+{
+    return deadline;
+}
+
+template <class Processor>
+inline bool BasicScheduler<Processor>::hastened() const
+{
+    return earlier;
+}
+
+template <class Processor>
+inline uint64_t BasicScheduler<Processor>::limit()
+{
+    earlier = false;
+    return deadline;
+}
+
+template <class Processor>
+inline std::size_t BasicScheduler<Processor>::dispatch(Processor & cpu, uint64_t clock)
+{
+    if (deadline > clock) {
+        return 0;
+    }
+    
+    return fire(cpu, clock);
+}
+
+template <class Processor>
+bool BasicScheduler<Processor>::later(const Event & first, const Event & second)
+{
+    if (first.clock != second.clock) {
+        return first.clock > second.clock;
+    }
+    
+    return first.id > second.id;
+}
+
+template <class Processor>
+uint64_t BasicScheduler<Processor>::schedule(uint64_t clock, Callback callback)
+{
+    uint64_t id = ids++;
+    
+    callbacks.emplace(id, std::move(callback));
+    
+    heap.push_back({ clock, id });
+    std::push_heap(heap.begin(), heap.end(), later);
+    
+    earlier |= clock < deadline;
+    deadline = heap.front().clock;
+    return id;
+}
+
+template <class Processor>
+bool BasicScheduler<Processor>::cancel(uint64_t id)
+{
+    if (callbacks.erase(id) == 0) {
+        return false;
+    }
+    
+    prune();
+    return true;
+}
+
+template <class Processor>
+void BasicScheduler<Processor>::clear()
+{
+    heap.clear();
+    callbacks.clear();
+    
+    deadline = UINT64_MAX;
+}
+
+template <class Processor>
+bool BasicScheduler<Processor>::empty() const
+{
+    return callbacks.empty();
+}
+
+template <class Processor>
+void BasicScheduler<Processor>::prune()
+{
+    while (!heap.empty() && callbacks.count(heap.front().id) == 0)
+    {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        heap.pop_back();
+    }
+    
+    deadline = heap.empty() ? UINT64_MAX : heap.front().clock;
+}
+
+template <class Processor>
+std::size_t BasicScheduler<Processor>::fire(Processor & cpu, uint64_t clock)
+{
+    std::size_t fired = 0;
+    
+    while (deadline <= clock)
+    {
+        auto id = heap.front().id;
+        
+        std::pop_heap(heap.begin(), heap.end(), later);
+        heap.pop_back();
+        
+        // Callback may schedule or cancel events
+        auto callback = std::move(callbacks.at(id));
+        callbacks.erase(id);
+        
+        prune();
+        
+        callback(cpu);
+        fired++;
+    }
+    
+    return fired;
+}
+
+#endif /* SCHEDULER_HPP */
@@ -17,21 +17,62 @@
 
 #include "status.hpp"
 
-Status::Status(uint8_t status)
+#pragma mark -
+#pragma mark Lookup tables
+
+const uint8_t StatusTables::szp[256] =
+{
+    0x46, 0x02, 0x02, 0x06, 0x02, 0x06, 0x06, 0x02, 0x02, 0x06, 0x06, 0x02, 0x06, 0x02, 0x02, 0x06,
+    0x02, 0x06, 0x06, 0x02, 0x06, 0x02, 0x02, 0x06, 0x06, 0x02, 0x02, 0x06, 0x02, 0x06, 0x06, 0x02,
+    0x02, 0x06, 0x06, 0x02, 0x06, 0x02, 0x02, 0x06, 0x06, 0x02, 0x02, 0x06, 0x02, 0x06, 0x06, 0x02,
+    0x06, 0x02, 0x02, 0x06, 0x02, 0x06, 0x06, 0x02, 0x02, 0x06, 0x06, 0x02, 0x06, 0x02, 0x02, 0x06,
+    0x02, 0x06, 0x06, 0x02, 0x06, 0x02, 0x02, 0x06, 0x06, 0x02, 0x02, 0x06, 0x02, 0x06, 0x06, 0x02,
+    0x06, 0x02, 0x02, 0x06, 0x02, 0x06, 0x06, 0x02, 0x02, 0x06, 0x06, 0x02, 0x06, 0x02, 0x02, 0x06,
+    0x06, 0x02, 0x02, 0x06, 0x02, 0x06, 0x06, 0x02, 0x02, 0x06, 0x06, 0x02, 0x06, 0x02, 0x02, 0x06,
+    0x02, 0x06, 0x06, 0x02, 0x06, 0x02, 0x02, 0x06, 0x06, 0x02, 0x02, 0x06, 0x02, 0x06, 0x06, 0x02,
+    0x82, 0x86, 0x86, 0x82, 0x86, 0x82, 0x82, 0x86, 0x86, 0x82, 0x82, 0x86, 0x82, 0x86, 0x86, 0x82,
+    0x86, 0x82, 0x82, 0x86, 0x82, 0x86, 0x86, 0x82, 0x82, 0x86, 0x86, 0x82, 0x86, 0x82, 0x82, 0x86,
+    0x86, 0x82, 0x82, 0x86, 0x82, 0x86, 0x86, 0x82, 0x82, 0x86, 0x86, 0x82, 0x86, 0x82, 0x82, 0x86,
+    0x82, 0x86, 0x86, 0x82, 0x86, 0x82, 0x82, 0x86, 0x86, 0x82, 0x82, 0x86, 0x82, 0x86, 0x86, 0x82,
+    0x86, 0x82, 0x82, 0x86, 0x82, 0x86, 0x86, 0x82, 0x82, 0x86, 0x86, 0x82, 0x86, 0x82, 0x82, 0x86,
+    0x82, 0x86, 0x86, 0x82, 0x86, 0x82, 0x82, 0x86, 0x86, 0x82, 0x82, 0x86, 0x82, 0x86, 0x86, 0x82,
+    0x82, 0x86, 0x86, 0x82, 0x86, 0x82, 0x82, 0x86, 0x86, 0x82, 0x82, 0x86, 0x82, 0x86, 0x86, 0x82,
+    0x86, 0x82, 0x82, 0x86, 0x82, 0x86, 0x86, 0x82, 0x82, 0x86, 0x86, 0x82, 0x86, 0x82, 0x82, 0x86
+};
+
+const uint8_t StatusTables::add[32] =
+{
+    0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10,
+    0x01, 0x11, 0x01, 0x11, 0x01, 0x11, 0x01, 0x11, 0x01, 0x11, 0x01, 0x11, 0x01, 0x11, 0x01, 0x11
+};
+
+const uint8_t StatusTables::sub[32] =
+{
+    0x01, 0x11, 0x01, 0x11, 0x01, 0x11, 0x01, 0x11, 0x01, 0x11, 0x01, 0x11, 0x01, 0x11, 0x01, 0x11,
+    0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10
+};
+
+template <class Policy>
+BasicStatus<Policy>::BasicStatus(uint8_t status)
 {
     this -> status = (status & 0xD7) | defaultState;
 }
 
-Status::operator uint8_t() const
+template <class Policy>
+BasicStatus<Policy>::operator uint8_t() const
 {
+    Flush();
     return this -> status;
 }
 
 #pragma mark -
 #pragma mark Set flags
 
-void Status::SetFlag(Status::Flags flag, bool value)
+template <class Policy>
+void BasicStatus<Policy>::SetFlag(Flags flag, bool value)
 {
+    Flush();
+    
     if (value) {
         status |= flag;
     } else {
@@ -39,42 +80,50 @@ void Status::SetFlag(Status::Flags flag, bool value)
     }
 }
 
-void Status::SetSign (bool flag)
+template <class Policy>
+void BasicStatus<Policy>::SetSign (bool flag)
 {
     SetFlag(S, flag);
 }
 
-void Status::SetSign (uint16_t value)
+template <class Policy>
+void BasicStatus<Policy>::SetSign (uint16_t value)
 {
     SetSign((bool)(value & 0x0080));
 }
 
-void Status::SetZero (bool flag)
+template <class Policy>
+void BasicStatus<Policy>::SetZero (bool flag)
 {
     SetFlag(Z, flag);
 }
 
-void Status::SetZero (uint16_t value)
+template <class Policy>
+void BasicStatus<Policy>::SetZero (uint16_t value)
 {
     SetZero((value & 0x00FF) == 0x0000);
 }
 
-void Status::SetAux (bool flag)
+template <class Policy>
+void BasicStatus<Policy>::SetAux (bool flag)
 {
     SetFlag(AC, flag);
 }
 
-void Status::SetAux (uint16_t value)
+template <class Policy>
+void BasicStatus<Policy>::SetAux (uint16_t value)
 {
     SetAux((value & 0x010) != 0);
 }
 
-void Status::SetParity (bool flag)
+template <class Policy>
+void BasicStatus<Policy>::SetParity (bool flag)
 {
     SetFlag(P, flag);
 }
 
-void Status::SetParity (uint16_t value)
+template <class Policy>
+void BasicStatus<Policy>::SetParity (uint16_t value)
 {
     value &= 0x00FF;
     
@@ -85,12 +134,14 @@ void Status::SetParity (uint16_t value)
     SetParity((bool)((~value) & 1));
 }
 
-void Status::SetCarry (bool flag)
+template <class Policy>
+void BasicStatus<Policy>::SetCarry (bool flag)
 {
     SetFlag(C, flag);
 }
 
-void Status::SetCarry (uint16_t value)
+template <class Policy>
+void BasicStatus<Policy>::SetCarry (uint16_t value)
 {
     SetCarry((value & 0x100) != 0);
 }
@@ -98,19 +149,22 @@ void Status::SetCarry (uint16_t value)
 #pragma mark -
 #pragma mark Set all
 
-void Status::SetAllFlags (uint16_t value)
+template <class Policy>
+void BasicStatus<Policy>::SetAllFlags (uint16_t value)
 {
     SetCarry    (value);
     SetAuxFlags (value);
 }
 
-void Status::SetAuxFlags (uint16_t value)
+template <class Policy>
+void BasicStatus<Policy>::SetAuxFlags (uint16_t value)
 {
     SetAux      (value);
     SetDecFlags (value);
 }
 
-void Status::SetDecFlags (uint16_t value)
+template <class Policy>
+void BasicStatus<Policy>::SetDecFlags (uint16_t value)
 {
     SetSign    (value);
     SetZero    (value);
@@ -120,40 +174,53 @@ void Status::SetDecFlags (uint16_t value)
 #pragma mark -
 #pragma mark Get flags
 
-uint8_t Status::GetSign() const
+template <class Policy>
+uint8_t BasicStatus<Policy>::GetSign() const
 {
-    return (status & S) >> 7;
+    return (SignZeroParity() & S) >> 7;
 }
 
-uint8_t Status::GetZero() const
+template <class Policy>
+uint8_t BasicStatus<Policy>::GetZero() const
 {
-    return (status & Z) >> 6;
+    return (SignZeroParity() & Z) >> 6;
 }
 
-uint8_t Status::GetAux() const
+template <class Policy>
+uint8_t BasicStatus<Policy>::GetAux() const
 {
+    Flush();
     return (status & AC) >> 4;
 }
 
-uint8_t Status::GetParity() const
+template <class Policy>
+uint8_t BasicStatus<Policy>::GetParity() const
 {
-    return (status & P) >> 2;
+    return (SignZeroParity() & P) >> 2;
 }
 
-uint8_t Status::GetCarry() const
+template <class Policy>
+uint8_t BasicStatus<Policy>::GetCarry() const
 {
-    return (status & C);
+    return Carry();
 }
 
 #pragma mark -
 #pragma mark Other
 
-void Status::Reset()
+template <class Policy>
+void BasicStatus<Policy>::Reset()
 {
+    Flush();
     status = defaultState;
 }
 
-void Status::InvertCarry()
+template <class Policy>
+void BasicStatus<Policy>::InvertCarry()
 {
+    Flush();
     status ^= C;
 }
+
+template class BasicStatus<Eager>;
+template class BasicStatus<Lazy>;
@@ -20,9 +20,14 @@
 
 #include <cstdint>
 
-class Status
+// Flag bits and lookup tables shared by every status policy
+class StatusTables
 {
-private:
+    // Host code and batch kernels compute status with the same tables
+    friend class Jit;
+    friend class CpuBatch;
+    
+protected:
     
     // Default status
     static const uint8_t defaultState = 0x02;
@@ -38,8 +43,6 @@ private:
     //     1 - (1)  - None / Always set
     // LO  0 - (C)  - Carry flag
     
-    uint8_t status = defaultState;
-    
     enum Flags
     {
         S  = (1 << 7),
@@ -48,13 +51,78 @@ private:
         P  = (1 << 2),
         C  = (1 << 0)
     };
+    
+    // Precomputed flags
+    // -----------------------------------
+    // szp - S, Z, P and fixed bits for each result byte
+    // add - AC and C for carries (a ^ b ^ sum) bits 4..8
+    // sub - AC and C when subtraction is done as a + ~b + 1
+    
+    static const uint8_t szp[256];
+    static const uint8_t add[32];
+    static const uint8_t sub[32];
+    
+    static uint8_t ArithmeticFlags (uint16_t result, uint16_t carries);
+    static uint8_t SubtractFlags   (uint16_t result, uint16_t carries);
+    static uint8_t IncrementFlags  (uint8_t  result, uint8_t  carry);
+    static uint8_t DecrementFlags  (uint8_t  result, uint8_t  carry);
+    static uint8_t LogicalFlags    (uint8_t  result, uint8_t  aux);
+};
 
+// Status is computed by every ALU operation
+struct Eager
+{
+    
+};
+
+// Last ALU operation is kept, status is computed
+// only when something reads it
+struct Lazy
+{
+    enum Operation : uint8_t
+    {
+        Done,
+        Arithmetic,
+        Subtract,
+        Increment,
+        Decrement,
+        Logical
+    };
+    
+    mutable Operation pending = Done;
+    
+    uint16_t result  = 0x0000;
+    uint16_t carries = 0x0000;
+    
+    void Defer(Operation operation, uint16_t result, uint16_t carries);
+};
+
+// Policy is Eager or Lazy. Both are instantiated in the
+// library, so they can be compared in one program
+template <class Policy>
+class BasicStatus : public StatusTables, private Policy
+{
+    friend class Jit;
+    
+private:
+    
+    mutable uint8_t status = defaultState;
+    
     void SetFlag(Flags flag, bool value);
+    
+    // Materialise pending operation into status
+    void Flush() const;
+    
+    // Carry without materialising whole status
+    uint8_t Carry() const;
+    
+    // Sign, zero and parity without materialising whole status
+    uint8_t SignZeroParity() const;
   
 public:
     
-    Status() = default;
-    Status(uint8_t status);
+    BasicStatus() = default;
+    BasicStatus(uint8_t status);
 
     operator uint8_t () const;
     
@@ -78,6 +146,13 @@ public:
     void SetAuxFlags (uint16_t value);
     void SetDecFlags (uint16_t value);
     
+    // Set whole status with table lookups
+    void SetArithmetic (uint16_t result, uint16_t carries);
+    void SetSubtract   (uint16_t result, uint16_t carries);
+    void SetIncrement  (uint8_t  result);
+    void SetDecrement  (uint8_t  result);
+    void SetLogical    (uint8_t  result, bool aux);
+    
 public:
     
     uint8_t GetSign()   const;
@@ -87,4 +162,198 @@ public:
     uint8_t GetCarry()  const;
 };
 
+// Policy of Cpu and Status, chosen by LAZY_FLAGS option
+#ifdef LAZY_FLAGS
+using StatusPolicy = Lazy;
+#else
+using StatusPolicy = Eager;
+#endif
+
+using Status = BasicStatus<StatusPolicy>;
+
+// Table driven flags
+// Defined inline, these are called by every ALU operation
+
+inline uint8_t StatusTables::ArithmeticFlags (uint16_t result, uint16_t carries)
+{
+    return szp[result & 0xFF] | add[(carries >> 4) & 0x1F];
+}
+
+inline uint8_t StatusTables::SubtractFlags (uint16_t result, uint16_t carries)
+{
+    return szp[result & 0xFF] | sub[(carries >> 4) & 0x1F];
+}
+
+inline uint8_t StatusTables::IncrementFlags (uint8_t result, uint8_t carry)
+{
+    return szp[result] | carry | ((result & 0x0F) == 0x00 ? AC : 0);
+}
+
+inline uint8_t StatusTables::DecrementFlags (uint8_t result, uint8_t carry)
+{
+    return szp[result] | carry | ((result & 0x0F) != 0x0F ? AC : 0);
+}
+
+inline uint8_t StatusTables::LogicalFlags (uint8_t result, uint8_t aux)
+{
+    return szp[result] | aux;
+}
+
+#pragma mark -
+#pragma mark Lazy
+
+inline void Lazy::Defer(Operation operation, uint16_t result, uint16_t carries)
+{
+    this -> pending = operation;
+    this -> result  = result;
+    this -> carries = carries;
+}
+
+template <>
+inline void BasicStatus<Lazy>::Flush() const
+{
+    switch (pending)
+    {
+        case Done:
+            return;
+            
+        case Arithmetic:
+            status = ArithmeticFlags(result, carries);
+            break;
+            
+        case Subtract:
+            status = SubtractFlags(result, carries);
+            break;
+            
+        case Increment:
+            status = IncrementFlags(result, carries);
+            break;
+            
+        case Decrement:
+            status = DecrementFlags(result, carries);
+            break;
+            
+        case Logical:
+            status = LogicalFlags(result, carries);
+            break;
+    }
+    
+    pending = Done;
+}
+
+template <>
+inline uint8_t BasicStatus<Lazy>::Carry() const
+{
+    switch (pending)
+    {
+        case Arithmetic:
+            return add[(carries >> 4) & 0x1F] & C;
+            
+        case Subtract:
+            return sub[(carries >> 4) & 0x1F] & C;
+            
+        case Increment:
+        case Decrement:
+            return carries;
+            
+        case Logical:
+            return 0;
+            
+        default:
+            return status & C;
+    }
+}
+
+// Every deferred operation takes S, Z and P from its result
+template <>
+inline uint8_t BasicStatus<Lazy>::SignZeroParity() const
+{
+    return pending == Done ? status : szp[result & 0xFF];
+}
+
+template <>
+inline void BasicStatus<Lazy>::SetArithmetic (uint16_t result, uint16_t carries)
+{
+    Defer(Arithmetic, result, carries);
+}
+
+template <>
+inline void BasicStatus<Lazy>::SetSubtract (uint16_t result, uint16_t carries)
+{
+    Defer(Subtract, result, carries);
+}
+
+template <>
+inline void BasicStatus<Lazy>::SetIncrement (uint8_t result)
+{
+    Defer(Increment, result, Carry());
+}
+
+template <>
+inline void BasicStatus<Lazy>::SetDecrement (uint8_t result)
+{
+    Defer(Decrement, result, Carry());
+}
+
+template <>
+inline void BasicStatus<Lazy>::SetLogical (uint8_t result, bool aux)
+{
+    Defer(Logical, result, aux ? AC : 0);
+}
+
+#pragma mark -
+#pragma mark Eager
+
+template <>
+inline void BasicStatus<Eager>::Flush() const
+{
+    
+}
+
+template <>
+inline uint8_t BasicStatus<Eager>::Carry() const
+{
+    return status & C;
+}
+
+template <>
+inline uint8_t BasicStatus<Eager>::SignZeroParity() const
+{
+    return status;
+}
+
+template <>
+inline void BasicStatus<Eager>::SetArithmetic (uint16_t result, uint16_t carries)
+{
+    status = ArithmeticFlags(result, carries);
+}
+
+template <>
+inline void BasicStatus<Eager>::SetSubtract (uint16_t result, uint16_t carries)
+{
+    status = SubtractFlags(result, carries);
+}
+
+template <>
+inline void BasicStatus<Eager>::SetIncrement (uint8_t result)
+{
+    status = IncrementFlags(result, status & C);
+}
+
+template <>
+inline void BasicStatus<Eager>::SetDecrement (uint8_t result)
+{
+    status = DecrementFlags(result, status & C);
+}
+
+template <>
+inline void BasicStatus<Eager>::SetLogical (uint8_t result, bool aux)
+{
+    status = LogicalFlags(result, aux ? AC : 0);
+}
+
+// Instantiated once in the library, see status.cpp
+extern template class BasicStatus<Eager>;
+extern template class BasicStatus<Lazy>;
+
 #endif /* STATUS_HPP */
@@ -0,0 +1,1636 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+#include "IO.hpp"
+#include "bdos.hpp"
+#include "console.hpp"
+#include "cpu.tpp"
+#include "cpubatch.hpp"
+#include "fleet.hpp"
+#include "memory.hpp"
+#include "memorymap.hpp"
+#include "portmap.hpp"
+#include "profiler.hpp"
+#include "throttle.hpp"
+
+#pragma mark -
+#pragma mark Devices
+
+// 64 KB accessed directly
+class Ram : public Memory
+{
+private:
+    std::array<uint8_t, 64 * 1024> memory {};
+    Pages table;
+    
+public:
+    Ram()
+    {
+        for (uint16_t page = 0; page < 256; page++) {
+            table.read[page] = table.write[page] = memory.data() + (page << 8);
+        }
+    }
+    
+    // Copy program to address
+    void load(uint16_t address, const std::vector<uint8_t> & program)
+    {
+        for (auto data : program) {
+            memory[address++] = data;
+        }
+    }
+    
+    virtual uint8_t read(uint16_t address) const override {
+        return memory[address];
+    }
+    
+    virtual void write(uint16_t address, uint8_t data) override {
+        memory[address] = data;
+    }
+    
+    virtual const Pages & pages() const override {
+        return table;
+    }
+};
+
+// Writing any port schedules event after delay,
+// the event records clock it has fired at
+class Timer : public IO<uint8_t>
+{
+public:
+    Cpu * cpu = nullptr;
+    
+    uint64_t delay  = 100;
+    uint64_t target = 0;
+    uint64_t fired  = 0;
+    
+    virtual uint8_t read(uint8_t) const override {
+        return 0x00;
+    }
+    
+    virtual void write(uint8_t, uint8_t) override
+    {
+        target = cpu -> getClock() + delay;
+        
+        cpu -> getScheduler().schedule(target, [this] (Cpu & cpu) {
+            fired = cpu.getClock();
+        });
+    }
+};
+
+// Ram with page 80 of device registers, reading them
+// is counted like a device would count acknowledges
+class Mapped : public Ram
+{
+private:
+    Pages table;
+    
+public:
+    mutable unsigned reads = 0;
+    
+    Mapped()
+    {
+        table = Ram::pages();
+        table.read[0x80] = table.write[0x80] = nullptr;
+    }
+    
+    virtual uint8_t read(uint16_t address) const override
+    {
+        if (address >> 8 == 0x80) {
+            reads++;
+        }
+        
+        return Ram::read(address);
+    }
+    
+    virtual const Pages & pages() const override {
+        return table;
+    }
+};
+
+// Ram without page pointers, BasicCpu calls it directly
+class Flat final : public IO<uint16_t>
+{
+private:
+    std::array<uint8_t, 64 * 1024> memory {};
+    
+public:
+    void load(uint16_t address, const std::vector<uint8_t> & program)
+    {
+        for (auto data : program) {
+            memory[address++] = data;
+        }
+    }
+    
+    virtual uint8_t read(uint16_t address) const override {
+        return memory[address];
+    }
+    
+    virtual void write(uint16_t address, uint8_t data) override {
+        memory[address] = data;
+    }
+};
+
+// Memory mapped register keeping the last value written
+class Latch : public IO<uint16_t>
+{
+public:
+    uint8_t value = 0x00;
+    unsigned writes = 0;
+    
+    virtual uint8_t read(uint16_t) const override {
+        return value;
+    }
+    
+    virtual void write(uint16_t, uint8_t data) override
+    {
+        value = data;
+        writes++;
+    }
+};
+
+// Console output collected in memory
+class Text : public Sink
+{
+public:
+    std::string text;
+    
+    virtual void write(const char * data, std::size_t size) override {
+        text.append(data, size);
+    }
+};
+
+#pragma mark -
+#pragma mark Programs
+
+// Folder with exercisers, see main()
+static std::string folder = "../asm/";
+
+// Processors ran the same program to the same state
+template <class X, class Y>
+static bool same(X & x, Y & y)
+{
+    for (auto index : { X::B, X::C, X::D, X::E, X::H, X::L, X::A })
+    {
+        if (x.getRegister(index) != y.getRegister((typename Y::Registers) index)) {
+            return false;
+        }
+    }
+    
+    for (uint32_t address = 0; address < 0x10000; address++)
+    {
+        if (x.getMemory(address) != y.getMemory(address)) {
+            return false;
+        }
+    }
+    
+    return x.getPair(X::PSW) == y.getPair(Y::PSW)
+        && x.getStack() == y.getStack()
+        && x.getCounter() == y.getCounter()
+        && x.getClock() == y.getClock()
+        && x.getInstructions() == y.getInstructions()
+        && x.isHalted() == y.isHalted();
+}
+
+static std::vector<uint8_t> image(const std::string & name)
+{
+    std::ifstream file(folder + name, std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+// Exerciser run through BDOS until it leaves through 0000
+struct Exercise
+{
+    std::string output;
+    uint64_t clock = 0;
+    
+    // Blocks translated to host code
+    uint64_t translated = 0;
+    
+    // Profiler dump, see Profiler::dump
+    std::string profile;
+};
+
+static Exercise exercise(const std::string & name, bool cache)
+{
+    Exercise result;
+    
+    auto program = image(name);
+    
+    if (program.empty()) {
+        return result;
+    }
+    
+    // 0000: HLT
+    auto ram = std::make_shared<Ram>();
+    ram -> load(0x0000, { 0x76 });
+    ram -> load(0x0100, program);
+    
+    auto text    = std::make_shared<Text>();
+    auto console = std::make_shared<Console>(text);
+    
+    Cpu cpu;
+    
+    cpu.connect(ram);
+    cpu.connect(console);
+    cpu.setCounter(0x0100);
+    
+    Bdos::install(cpu, std::make_shared<Bdos>(console));
+    
+    if (cache) {
+        cpu.enableCache();
+    }
+    
+    while (!cpu.isHalted()) {
+        cpu.step(1000000);
+    }
+    
+    console -> flush();
+    
+    result.output = text -> text;
+    result.clock  = cpu.getClock();
+    
+#ifdef JIT
+    result.translated = cpu.getJitStatistics().translated;
+#endif
+    
+#ifdef PROFILE
+    std::string path = name + (cache ? ".cache.prof" : ".prof");
+    
+    if (cpu.getProfiler().dump(path))
+    {
+        std::ifstream dump(path, std::ios::binary);
+        result.profile.assign((std::istreambuf_iterator<char>(dump)), std::istreambuf_iterator<char>());
+    }
+    
+    std::remove(path.c_str());
+#endif
+    
+    return result;
+}
+
+// Exerciser prints expected text with the same output, clock
+// and profile when run from cache and, in JIT builds, host code
+static bool exerciser(const std::string & name, const std::string & expected)
+{
+    auto interpreted = exercise(name, false);
+    auto cached = exercise(name, true);
+    
+#ifdef JIT
+    if (cached.translated == 0) {
+        return false;
+    }
+#endif
+    
+    return interpreted.output.find(expected) != std::string::npos
+        && cached.output  == interpreted.output
+        && cached.clock   == interpreted.clock
+        && cached.profile == interpreted.profile;
+}
+
+// Exerciser stopped by limits of run() or step() is in the
+// same state and clock interpreted and from cache at every stop
+static bool cachedSame(const std::string & name, bool steps)
+{
+    auto program = image(name);
+    
+    if (program.empty()) {
+        return false;
+    }
+    
+    Cpu cpus[2];
+    std::shared_ptr<Text> texts[2];
+    std::shared_ptr<Console> consoles[2];
+    
+    for (int index = 0; index < 2; index++)
+    {
+        // 0000: HLT
+        auto ram = std::make_shared<Ram>();
+        ram -> load(0x0000, { 0x76 });
+        ram -> load(0x0100, program);
+        
+        texts[index]    = std::make_shared<Text>();
+        consoles[index] = std::make_shared<Console>(texts[index]);
+        
+        cpus[index].connect(ram);
+        cpus[index].connect(consoles[index]);
+        cpus[index].setCounter(0x0100);
+        
+        Bdos::install(cpus[index], std::make_shared<Bdos>(consoles[index]));
+    }
+    
+    cpus[1].enableCache();
+    
+    // Odd limits end runs inside blocks
+    while (!cpus[0].isHalted())
+    {
+        for (auto & cpu : cpus)
+        {
+            if (steps) {
+                cpu.step(99991);
+            }
+            else {
+                cpu.run(1000003);
+            }
+        }
+        
+        if (!same(cpus[0], cpus[1])) {
+            return false;
+        }
+    }
+    
+    for (auto & console : consoles) {
+        console -> flush();
+    }
+    
+    return texts[0] -> text == texts[1] -> text;
+}
+
+#pragma mark -
+#pragma mark Cases
+
+// Event scheduled by device in the middle of run() fires
+// at its clock, not at the end of run()
+static bool scheduledByPort(bool cache, bool halt)
+{
+    auto ram   = std::make_shared<Ram>();
+    auto timer = std::make_shared<Timer>();
+    
+    Cpu cpu;
+    
+    cpu.connect(ram);
+    cpu.connect(timer);
+    timer -> cpu = &cpu;
+    
+    // 0000: OUT 10, then JMP 0002 or HLT
+    if (halt) {
+        ram -> load(0x0000, { 0xD3, 0x10, 0x76 });
+    }
+    else {
+        ram -> load(0x0000, { 0xD3, 0x10, 0xC3, 0x02, 0x00 });
+    }
+    
+    if (cache) {
+        cpu.enableCache();
+    }
+    
+    cpu.run(1000000);
+    
+    // Halted processor is moved right to the event,
+    // running one stops at the next operation
+    if (halt) {
+        return timer -> fired == timer -> target;
+    }
+    
+    return timer -> fired >= timer -> target && timer -> fired < timer -> target + 10;
+}
+
+// Interrupt requested before EI is accepted right after the
+// following operation. RST pushes address of the next one
+static bool interruptAfterEnable(bool cache)
+{
+    std::vector<uint8_t> program {
+        0x31, 0x00, 0x02,   // 0100: LXI SP, 0200
+        0xFB,               // 0103: EI
+        0x04,               // 0104: INR B
+        0x04,               //       INR B
+        0x04,               //       INR B
+        0x76                //       HLT
+    };
+    
+    auto ram = std::make_shared<Ram>();
+    
+    // 0038: HLT
+    ram -> load(0x0038, { 0x76 });
+    ram -> load(0x0100, program);
+    
+    Cpu cpu;
+    
+    cpu.connect(ram);
+    cpu.setCounter(0x0100);
+    
+    if (cache) {
+        cpu.enableCache();
+    }
+    
+    // RST 7
+    cpu.interrupt(0xFF);
+    cpu.step(100);
+    
+    // LXI, EI, INR, RST and HLT
+    return cpu.isHalted() && !cpu.isInterruptEnabled()
+        && cpu.getRegister(Cpu::B) == 1
+        && cpu.getCounter() == 0x0039
+        && cpu.getStack() == 0x01FE
+        && cpu.getMemory(0x01FE) == 0x05 && cpu.getMemory(0x01FF) == 0x01
+        && cpu.getClock() == 10 + 4 + 5 + 11 + 4
+        && cpu.getInstructions() == 5;
+}
+
+// Interrupt wakes halted processor, handler returns
+// to the operation following HLT
+static bool interruptWakesHalted(bool cache)
+{
+    std::vector<uint8_t> program {
+        0x31, 0x00, 0x02,   // 0100: LXI SP, 0200
+        0xFB,               // 0103: EI
+        0x76,               // 0104: HLT
+        0x04,               // 0105: INR B
+        0x76                //       HLT
+    };
+    
+    auto ram = std::make_shared<Ram>();
+    
+    // 0038: INR C; EI; RET
+    ram -> load(0x0038, { 0x0C, 0xFB, 0xC9 });
+    ram -> load(0x0100, program);
+    
+    Cpu cpu;
+    
+    cpu.connect(ram);
+    cpu.setCounter(0x0100);
+    
+    if (cache) {
+        cpu.enableCache();
+    }
+    
+    cpu.step(100);
+    
+    bool waiting = cpu.isHalted() && cpu.getCounter() == 0x0105 && cpu.getClock() == 10 + 4 + 4;
+    
+    cpu.interrupt(0xFF);
+    cpu.step(100);
+    
+    // RST, INR C, EI, RET, INR B and HLT
+    return waiting && cpu.isHalted() && cpu.isInterruptEnabled()
+        && cpu.getRegister(Cpu::B) == 1
+        && cpu.getRegister(Cpu::C) == 1
+        && cpu.getCounter() == 0x0107
+        && cpu.getStack() == 0x0200
+        && cpu.getClock() == 10 + 4 + 4 + 11 + 5 + 4 + 10 + 5 + 4
+        && cpu.getInstructions() == 9;
+}
+
+// Store into the middle of cached block drops only that
+// block, other blocks of the same page stay cached
+static bool partialInvalidation()
+{
+    std::vector<uint8_t> program {
+        0x31, 0x00, 0x10,   // 0000: LXI SP, 1000
+        0x06, 0x02,         //       MVI B, 02
+        0xCD, 0x20, 0x00,   // 0005: CALL 0020
+        0x3E, 0x14,         //       MVI A, 14
+        0x32, 0x31, 0x00,   //       STA 0031
+        0xCD, 0x30, 0x00,   // 000D: CALL 0030
+        0x05,               //       DCR B
+        0xC2, 0x05, 0x00,   //       JNZ 0005
+        0x76                //       HLT
+    };
+    
+    auto ram = std::make_shared<Ram>();
+    
+    ram -> load(0x0000, program);
+    ram -> load(0x0020, { 0x0C, 0x0C, 0xC9 });         // INR C; INR C; RET
+    ram -> load(0x0030, { 0x00, 0x00, 0x00, 0xC9 });   // NOP; NOP, becomes INR D; NOP; RET
+    
+    Cpu cpu;
+    
+    cpu.connect(ram);
+    cpu.enableCache();
+    cpu.step(100);
+    
+    auto statistics = cpu.getCacheStatistics();
+    
+    // The first store precedes decoding of 0030. The second one
+    // drops it and cuts the running block, CALL at 000D is
+    // decoded alone. Blocks at 0020, 0008 and 0010 are hit
+    return cpu.isHalted()
+        && cpu.getRegister(Cpu::C) == 4
+        && cpu.getRegister(Cpu::D) == 2
+        && statistics.invalidations == 1
+        && statistics.dropped == 1
+        && statistics.misses == 9
+        && statistics.hits == 3;
+}
+
+#if !defined(ASMLOG) && !defined(PROFILE)
+// Polling loop entered with accumulator and flags it doesn't
+// keep is skipped and ends in the same state as interpreted
+static bool idleAfterEntry()
+{
+    // 0100: MVI A, 42; STC; JMP 0106
+    // 0106: IN 01; ANI 01; JZ 0106
+    std::vector<uint8_t> program { 0x3E, 0x42, 0x37, 0xC3, 0x06, 0x01, 0xDB, 0x01, 0xE6, 0x01, 0xCA, 0x06, 0x01 };
+    
+    Cpu interpreted, cached;
+    
+    for (auto cpu : { &interpreted, &cached })
+    {
+        auto ram = std::make_shared<Ram>();
+        ram -> load(0x0100, program);
+        
+        // Default port reads zero until the next event
+        cpu -> connect(ram);
+        cpu -> setCounter(0x0100);
+    }
+    
+    cached.enableCache();
+    
+    interpreted.run(1000000);
+    cached.run(1000000);
+    
+    return cached.getCacheStatistics().skipped > 0
+        && cached.getClock()   == interpreted.getClock()
+        && cached.getCounter() == interpreted.getCounter()
+        && cached.getRegister(Cpu::A) == interpreted.getRegister(Cpu::A);
+}
+#endif
+
+#ifdef ASMLOG
+// Records show clock before operation whether it was
+// interpreted, executed from block or by clock()
+static bool traceClock()
+{
+    // 0000: NOP; MVI A, 01; LXI H, 0000; ADD A; JMP 0000
+    std::vector<uint8_t> program { 0x00, 0x3E, 0x01, 0x21, 0x00, 0x00, 0x87, 0xC3, 0x00, 0x00 };
+    
+    Cpu interpreted, cached, clocked;
+    
+    for (auto cpu : { &interpreted, &cached, &clocked })
+    {
+        auto ram = std::make_shared<Ram>();
+        ram -> load(0x0000, program);
+        
+        cpu -> connect(ram);
+    }
+    
+    cached.enableCache();
+    
+    interpreted.run(1000);
+    cached.run(1000);
+    
+    while (clocked.getClock() < 1000) {
+        clocked.clock();
+    }
+    
+    auto & expected = interpreted.getTrace();
+    
+    for (auto cpu : { &cached, &clocked })
+    {
+        auto & trace = cpu -> getTrace();
+        
+        for (std::size_t index = 0; index < expected.size(); index++)
+        {
+            if (trace[index].clock != expected[index].clock || trace[index].counter != expected[index].counter) {
+                return false;
+            }
+        }
+    }
+    
+    return expected.size() > 0 && expected[1].clock == 4;
+}
+
+// Trace doesn't read device registers
+static bool traceDevices()
+{
+    auto ram = std::make_shared<Mapped>();
+    
+    // 0000: LXI H, 8000; LXI B, 8001; MOV A, M; LDA 8002; HLT
+    ram -> load(0x0000, { 0x21, 0x00, 0x80, 0x01, 0x01, 0x80, 0x7E, 0x3A, 0x02, 0x80, 0x76 });
+    
+    Cpu cpu;
+    
+    cpu.connect(ram);
+    cpu.run(100);
+    
+    return ram -> reads == 2;
+}
+#endif
+
+#ifdef JIT
+// Program run by interpreter and by host code
+static bool translated(const std::vector<uint8_t> & program, bool mapped = false)
+{
+    Cpu interpreted, compiled;
+    
+    std::shared_ptr<Mapped> memories[2];
+    
+    for (auto index : { 0, 1 })
+    {
+        memories[index] = std::make_shared<Mapped>();
+        memories[index] -> load(0x0000, program);
+        
+        (index ? compiled : interpreted).connect(mapped ? memories[index] : std::make_shared<Ram>(*memories[index]));
+    }
+    
+    compiled.enableCache();
+    
+    interpreted.run(1000000);
+    compiled.run(1000000);
+    
+    return same(interpreted, compiled)
+        && memories[0] -> reads == memories[1] -> reads
+        && compiled.getJitStatistics().translated > 0;
+}
+
+// Operations of every translated kind, DAA in the middle
+// of subroutine is interpreted after host code stops
+static bool jitOperations()
+{
+    return translated({
+        0x31, 0x00, 0x80,   // 0000: LXI SP, 8000
+        0x21, 0x00, 0x40,   // 0003: LXI H, 4000
+        0x01, 0x00, 0x00,   // 0006: LXI B, 0000
+        0x11, 0x34, 0x12,   // 0009: LXI D, 1234
+        0x78,               // 000C: MOV A, B
+        0x81,               //       ADD C
+        0xCE, 0x37,         //       ACI 37
+        0x77,               //       MOV M, A
+        0x17,               //       RAL
+        0x9A,               //       SBB D
+        0xA3,               //       ANA E
+        0xEE, 0x5A,         //       XRI 5A
+        0xB4,               //       ORA H
+        0xBD,               //       CMP L
+        0xF5,               //       PUSH PSW
+        0xCD, 0x40, 0x00,   //       CALL 0040
+        0xF1,               //       POP PSW
+        0x23,               //       INX H
+        0x04,               //       INR B
+        0x0D,               //       DCR C
+        0xC2, 0x0C, 0x00,   //       JNZ 000C
+        0x22, 0x00, 0x50,   //       SHLD 5000
+        0x2A, 0x00, 0x50,   //       LHLD 5000
+        0xF5,               //       PUSH PSW
+        0x76,               //       HLT
+        
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        
+        0xEB,               // 0040: XCHG
+        0x19,               //       DAD D
+        0xEB,               //       XCHG
+        0x3F,               //       CMC
+        0x1F,               //       RAR
+        0x96,               //       SUB M
+        0x27,               //       DAA
+        0x0F,               //       RRC
+        0x07,               //       RLC
+        0x2F,               //       CMA
+        0x37,               //       STC
+        0x39,               //       DAD SP
+        0x3B,               //       DCX SP
+        0x33,               //       INX SP
+        0x12,               //       STAX D
+        0x0A,               //       LDAX B
+        0xC9                //       RET
+    });
+}
+
+// Store to decoded operand leaves host code before it
+static bool jitModifiedCode()
+{
+    return translated({
+        0x31, 0x00, 0x80,   // 0000: LXI SP, 8000
+        0x0E, 0x00,         // 0003: MVI C, 00
+        0x3E, 0x00,         // 0005: MVI A, 00
+        0x3C,               //       INR A
+        0x32, 0x06, 0x00,   //       STA 0006
+        0x0D,               //       DCR C
+        0xC2, 0x05, 0x00,   //       JNZ 0005
+        0xF5,               //       PUSH PSW
+        0x76                //       HLT
+    });
+}
+
+// Device registers are read through bus every time
+static bool jitMappedMemory()
+{
+    return translated({
+        0x0E, 0x00,         // 0000: MVI C, 00
+        0x3A, 0x00, 0x80,   // 0002: LDA 8000
+        0x21, 0x01, 0x80,   //       LXI H, 8001
+        0x86,               //       ADD M
+        0x0D,               //       DCR C
+        0xC2, 0x02, 0x00,   //       JNZ 0002
+        0x76                //       HLT
+    }, true);
+}
+// Flags of every arithmetic kind are pushed to stack,
+// same() compares them through memory and PSW
+static bool jitFlags()
+{
+    return translated({
+        0x31, 0x00, 0x80,   // 0000: LXI SP, 8000
+        0x06, 0x00,         // 0003: MVI B, 00
+        0x0E, 0x80,         // 0005: MVI C, 80
+        0x78, 0x81, 0xF5,   // 0007: MOV A, B; ADD C; PUSH PSW
+        0x78, 0x89, 0xF5,   //       MOV A, B; ADC C; PUSH PSW
+        0x78, 0x91, 0xF5,   //       MOV A, B; SUB C; PUSH PSW
+        0x78, 0x99, 0xF5,   //       MOV A, B; SBB C; PUSH PSW
+        0x78, 0xA1, 0xF5,   //       MOV A, B; ANA C; PUSH PSW
+        0x78, 0xA9, 0xF5,   //       MOV A, B; XRA C; PUSH PSW
+        0x78, 0xB1, 0xF5,   //       MOV A, B; ORA C; PUSH PSW
+        0x78, 0xB9, 0xF5,   //       MOV A, B; CMP C; PUSH PSW
+        0x78, 0x3C, 0xF5,   //       MOV A, B; INR A; PUSH PSW
+        0x78, 0x3D, 0xF5,   //       MOV A, B; DCR A; PUSH PSW
+        0x0D,               //       DCR C
+        0x04,               //       INR B
+        0xC2, 0x07, 0x00,   //       JNZ 0007
+        0x76                //       HLT
+    });
+}
+#endif
+
+// Final bus called without virtual dispatch runs
+// program like Cpu with page pointers
+static bool templateBus(bool cache)
+{
+    std::vector<uint8_t> program {
+        0x31, 0x00, 0x80,   // 0000: LXI SP, 8000
+        0x21, 0x00, 0x40,   // 0003: LXI H, 4000
+        0x06, 0x00,         // 0006: MVI B, 00
+        0x78,               // 0008: MOV A, B
+        0x86,               //       ADD M
+        0x77,               //       MOV M, A
+        0xC5,               //       PUSH B
+        0xCD, 0x16, 0x00,   //       CALL 0016
+        0xC1,               //       POP B
+        0x23,               //       INX H
+        0x05,               //       DCR B
+        0xC2, 0x08, 0x00,   //       JNZ 0008
+        0x76,               //       HLT
+        0x07,               // 0016: RLC
+        0x32, 0x00, 0x50,   //       STA 5000
+        0xC9                //       RET
+    };
+    
+    auto ram = std::make_shared<Ram>();
+    auto bus = std::make_shared<Flat>();
+    
+    ram -> load(0x0000, program);
+    bus -> load(0x0000, program);
+    
+    Cpu cpu;
+    BasicCpu<Flat, IO<uint8_t>> flat;
+    
+    cpu.connect(ram);
+    flat.connect(bus);
+    
+    if (cache)
+    {
+        cpu.enableCache();
+        flat.enableCache();
+    }
+    
+    cpu.run(100000);
+    flat.run(100000);
+    
+    return cpu.isHalted() && same(cpu, flat);
+}
+
+// Stores to RAM and window pages drop decoded code, stores
+// dropped by ROM and unmapped pages or taken by device don't
+static bool mappedStores(bool cache)
+{
+    std::vector<uint8_t> ram(0x1000), rom {
+        0x3E, 0x04,         // 1000: MVI A, 04
+        0x32, 0x00, 0x10,   //       STA 1000
+        0x32, 0x00, 0x20,   //       STA 2000
+        0x32, 0x00, 0x30,   //       STA 3000
+        0xC3, 0x00, 0x40    //       JMP 4000
+    };
+    
+    std::vector<uint8_t> bank {
+        0x32, 0x04, 0x40,   // 4000: STA 4004
+        0x00,               //       NOP
+        0x00,               // 4004: NOP, becomes INR B
+        0xC3, 0x00, 0x00    //       JMP 0000
+    };
+    
+    std::vector<uint8_t> code {
+        0x32, 0x04, 0x00,   // 0000: STA 0004
+        0x00,               //       NOP
+        0x00,               // 0004: NOP, becomes INR B
+        0x76                //       HLT
+    };
+    
+    rom.resize(0x100);
+    bank.resize(0x100);
+    
+    std::copy(code.begin(), code.end(), ram.begin());
+    
+    auto map   = std::make_shared<MemoryMap>();
+    auto latch = std::make_shared<Latch>();
+    
+    map -> ram(0x0000, ram.data(), ram.size());
+    map -> rom(0x1000, rom.data(), rom.size());
+    map -> device(0x3000, 0x100, latch);
+    map -> window(0x4000, 0x100, { bank.data() });
+    
+    Cpu cpu;
+    
+    cpu.connect(map);
+    cpu.setCounter(0x1000);
+    
+    if (cache) {
+        cpu.enableCache();
+    }
+    
+    cpu.step(100);
+    
+    bool stored = cpu.isHalted()
+        && cpu.getRegister(Cpu::B) == 2
+        && cpu.getMemory(0x1000) == 0x3E
+        && cpu.getMemory(0x2000) == 0xFF
+        && latch -> writes == 1 && latch -> value == 0x04;
+    
+    if (!cache) {
+        return stored;
+    }
+    
+    auto statistics = cpu.getCacheStatistics();
+    
+    return stored && statistics.invalidations == 2 && statistics.dropped == 2;
+}
+
+// Bank selected by OUT through port map shared with console.
+// Block decoded from the other bank is never run
+static bool switchedBanks(bool cache)
+{
+    std::vector<uint8_t> ram(0x1000), banks[2];
+    
+    std::vector<uint8_t> program {
+        0x31, 0x00, 0x10,   // 0000: LXI SP, 1000
+        0x06, 0x02,         //       MVI B, 02
+        0xCD, 0x00, 0x40,   // 0005: CALL 4000
+        0x3E, 0x01,         //       MVI A, 01
+        0xD3, 0xF9,         //       OUT F9
+        0xCD, 0x00, 0x40,   //       CALL 4000
+        0xAF,               //       XRA A
+        0xD3, 0xF9,         //       OUT F9
+        0x05,               //       DCR B
+        0xC2, 0x05, 0x00,   //       JNZ 0005
+        0x76                //       HLT
+    };
+    
+    std::copy(program.begin(), program.end(), ram.begin());
+    
+    // 4000: MVI A, '0' or '1'; OUT 01; RET
+    for (uint8_t index = 0; index < 2; index++)
+    {
+        banks[index] = { 0x3E, (uint8_t) ('0' + index), 0xD3, 0x01, 0xC9 };
+        banks[index].resize(0x100);
+    }
+    
+    auto map = std::make_shared<MemoryMap>();
+    
+    map -> ram(0x0000, ram.data(), ram.size());
+    auto window = map -> window(0x4000, 0x100, { banks[0].data(), banks[1].data() });
+    
+    auto text    = std::make_shared<Text>();
+    auto console = std::make_shared<Console>(text);
+    auto ports   = std::make_shared<PortMap>();
+    
+    ports -> attach(0x01, console);
+    ports -> attach(0xF9, std::make_shared<BankSwitch>(map, window, 0xF9));
+    
+    Cpu cpu;
+    
+    cpu.connect(map);
+    cpu.connect(ports);
+    
+    if (cache) {
+        cpu.enableCache();
+    }
+    
+    cpu.step(1000);
+    console -> flush();
+    
+    // CALL, MVI, OUT, RET in both banks, twice
+    bool printed = cpu.isHalted() && text -> text == "0101" && map -> selected(window) == 0
+        && cpu.getClock() == 10 + 7 + 2 * (17 + 7 + 10 + 10 + 7 + 10 + 17 + 7 + 10 + 10 + 4 + 10 + 5 + 10) + 4;
+    
+    if (!cache) {
+        return printed;
+    }
+    
+    // Blocks at 4000 and 4004 are decoded again on every call,
+    // seven blocks of RAM only once and four of them are reused
+    auto statistics = cpu.getCacheStatistics();
+    
+    return printed && statistics.misses == 7 + 4 * 2 && statistics.hits == 4;
+}
+
+// 400000 cycles at 2 MHz take 200 ms of host time. Throttle
+// never finishes early, the late bound leaves room for a busy host
+static bool throttlePacing()
+{
+    // 0000: JMP 0000
+    std::vector<uint8_t> program { 0xC3, 0x00, 0x00 };
+    
+    auto ram = std::make_shared<Ram>();
+    ram -> load(0x0000, program);
+    
+    Cpu cpu;
+    cpu.connect(ram);
+    
+    Throttle throttle(cpu, 2000000);
+    
+    auto start = std::chrono::steady_clock::now();
+    uint64_t cycles = throttle.run(400000);
+    auto finish = std::chrono::steady_clock::now();
+    
+    double expected = cycles / 2e6;
+    double elapsed = std::chrono::duration<double>(finish - start).count();
+    
+    return cycles >= 400000
+        && throttle.getStatistics().sleeps > 0
+        && elapsed >= expected * 0.99
+        && elapsed <= expected * 1.5;
+}
+
+// Eager and lazy status agree on every flag. PUSH PSW stores
+// status after ALU operations, conditional jumps and carry
+// users read single flags of pending operation
+static bool statusPolicies()
+{
+    std::vector<uint8_t> program {
+        0x31, 0x00, 0x80,   // 0000: LXI  SP, 8000
+        0x78,               //       MOV  A, B
+        0x81, 0xF5,         //       ADD  C; PUSH PSW
+        0x88, 0xF5,         //       ADC  B; PUSH PSW
+        0x91, 0xF5,         //       SUB  C; PUSH PSW
+        0x98, 0xF5,         //       SBB  B; PUSH PSW
+        0x27, 0xF5,         //       DAA;    PUSH PSW
+        0xA1, 0xF5,         //       ANA  C; PUSH PSW
+        0xC6, 0x5A,         //       ADI  5A
+        0x17, 0xF5,         //       RAL;    PUSH PSW
+        0xA8, 0xF5,         //       XRA  B; PUSH PSW
+        0xB1, 0xF5,         //       ORA  C; PUSH PSW
+        0xB8, 0xF5,         //       CMP  B; PUSH PSW
+        0x3C, 0xF5,         //       INR  A; PUSH PSW
+        0x3D, 0xF5,         //       DCR  A; PUSH PSW
+        0xDE, 0x33,         //       SBI  33
+        0xDA, 0x24, 0x00,   //       JC   0024
+        0x14,               //       INR  D
+        0xE2, 0x28, 0x00,   // 0024: JPO  0028
+        0x1C,               //       INR  E
+        0x0C,               // 0028: INR  C
+        0xC2, 0x00, 0x00,   //       JNZ  0000
+        0x04,               //       INR  B
+        0xC2, 0x00, 0x00,   //       JNZ  0000
+        0x76                //       HLT
+    };
+    
+    auto eager = std::make_shared<Ram>();
+    auto lazy  = std::make_shared<Ram>();
+    
+    eager -> load(0x0000, program);
+    lazy  -> load(0x0000, program);
+    
+    BasicCpu<IO<uint16_t>, IO<uint8_t>, Eager> first;
+    BasicCpu<IO<uint16_t>, IO<uint8_t>, Lazy>  second;
+    
+    first.connect(eager);
+    second.connect(lazy);
+    
+    // Lockstep, so every operand pair B, C is compared
+    while (!first.isHalted())
+    {
+        first.step(1);
+        second.step(1);
+        
+        if (first.getPair(first.PSW) != second.getPair(second.PSW) || first.getCounter() != second.getCounter()) {
+            return false;
+        }
+    }
+    
+    return first.getRegister(first.D) != 0 && same(first, second);
+}
+
+// Halted lane adds only instructions it executed
+static bool batchHalted()
+{
+    CpuBatch batch(2);
+    
+    batch.load(0, 0x0000, { 0xC3, 0x00, 0x00 }); // 0000: JMP 0000
+    batch.load(1, 0x0000, { 0x76 });             // 0000: HLT
+    
+    batch.step(1000);
+    
+    return batch.getInstructions() == 1001
+        && batch.getInstructions(0) == 1000
+        && batch.getInstructions(1) == 1
+        && batch.isHalted(1);
+}
+
+// Lane of batch with interface of Cpu for same()
+class Lane
+{
+private:
+    CpuBatch & batch;
+    std::size_t lane;
+    
+public:
+    using Registers = Cpu::Registers;
+    static const Cpu::Pairs PSW = Cpu::PSW;
+    
+    Lane(CpuBatch & batch, std::size_t lane) : batch(batch), lane(lane)
+    {
+        
+    }
+    
+    uint8_t  getRegister(Registers index) const { return batch.getRegister(lane, index); }
+    uint16_t getPair(Cpu::Pairs index) const    { return batch.getPair(lane, index); }
+    uint16_t getStack() const                   { return batch.getStack(lane); }
+    uint16_t getCounter() const                 { return batch.getCounter(lane); }
+    uint8_t  getMemory(uint16_t address) const  { return batch.getMemory(lane, address); }
+    uint64_t getClock() const                   { return batch.getClock(lane); }
+    uint64_t getInstructions() const            { return batch.getInstructions(lane); }
+    bool     isHalted() const                   { return batch.isHalted(lane); }
+};
+
+// Every lane ends in the same state as Cpu running its
+// program from 0100 with B set to seed. BDOS returns at once
+static bool batchLanes(const std::vector<std::vector<uint8_t>> & programs, const std::vector<uint8_t> & seeds)
+{
+    CpuBatch batch(programs.size());
+    
+    for (std::size_t lane = 0; lane < batch.size(); lane++)
+    {
+        if (programs[lane].empty()) {
+            return false;
+        }
+        
+        batch.load(lane, 0x0000, { 0x76 }); // 0000: HLT
+        batch.load(lane, 0x0005, { 0xC9 }); // 0005: RET
+        batch.load(lane, 0x0100, programs[lane]);
+        
+        batch.setRegister(lane, Cpu::B, seeds[lane]);
+        batch.setCounter(lane, 0x0100);
+    }
+    
+    for (int slice = 0; slice < 100; slice++) {
+        batch.step(1000000);
+    }
+    
+    for (std::size_t lane = 0; lane < batch.size(); lane++)
+    {
+        auto ram = std::make_shared<Ram>();
+        
+        ram -> load(0x0000, { 0x76 });
+        ram -> load(0x0005, { 0xC9 });
+        ram -> load(0x0100, programs[lane]);
+        
+        Cpu cpu;
+        
+        cpu.connect(ram);
+        cpu.setRegister(Cpu::B, seeds[lane]);
+        cpu.setCounter(0x0100);
+        
+        for (int slice = 0; slice < 100 && !cpu.isHalted(); slice++) {
+            cpu.step(1000000);
+        }
+        
+        Lane view(batch, lane);
+        
+        if (!cpu.isHalted() || !same(cpu, view)) {
+            return false;
+        }
+    }
+    
+    return batch.getStatistics().grouped > 0;
+}
+
+static bool batchSame()
+{
+    auto program = image("8080PRE.com");
+    return batchLanes({ program, program, program }, { 0, 0, 0 });
+}
+
+static bool batchPrograms()
+{
+    return batchLanes({ image("CPUTEST.com"), image("8080PRE.com"), image("8080.com") }, { 0, 0, 0 });
+}
+
+// Lanes loop seed times and return by different
+// conditions, then halt one after another
+static bool batchData()
+{
+    std::vector<uint8_t> program
+    {
+        0x31, 0x00, 0xF0,   // 0100: LXI  SP, F000
+        0x21, 0x00, 0x20,   // 0103: LXI  H, 2000
+        0x70,               // 0106: MOV  M, B
+        0x23,               // 0107: INX  H
+        0x80,               // 0108: ADD  B
+        0xCD, 0x20, 0x01,   // 0109: CALL 0120
+        0x05,               // 010C: DCR  B
+        0xC2, 0x06, 0x01,   // 010D: JNZ  0106
+        0x27,               // 0110: DAA
+        0xF5,               // 0111: PUSH PSW
+        0xC1,               // 0112: POP  B
+        0x76,               // 0113: HLT
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x1F,               // 0120: RAR
+        0xD8,               // 0121: RC
+        0x3C,               // 0122: INR  A
+        0xC9                // 0123: RET
+    };
+    
+    return batchLanes(std::vector<std::vector<uint8_t>>(8, program), { 0, 1, 2, 3, 5, 8, 13, 21 });
+}
+
+// Pool threads serve several runs and stop with the fleet
+static bool fleetRuns()
+{
+    Fleet fleet(3);
+    
+    for (int index = 0; index < 8; index++)
+    {
+        // 0000: JMP 0000
+        auto memory = std::make_shared<Ram>();
+        memory -> load(0x0000, { 0xC3, 0x00, 0x00 });
+        
+        auto cpu = std::make_unique<Cpu>();
+        cpu -> connect(memory);
+        
+        fleet.add(std::move(cpu));
+    }
+    
+    fleet.setSlice(1000);
+    
+    for (int run = 0; run < 5; run++) {
+        fleet.run(10000);
+    }
+    
+    bool valid = fleet.getCycles() == 8 * 50000;
+    
+    for (std::size_t index = 0; index < fleet.size(); index++) {
+        valid &= fleet.getCycles(index) == 50000;
+    }
+    
+    return valid;
+}
+
+#ifdef __linux__
+// Calling thread is pinned only while it runs processors
+static bool fleetPinning()
+{
+    cpu_set_t before, after;
+    
+    pthread_getaffinity_np(pthread_self(), sizeof(before), &before);
+    
+    Fleet fleet(2);
+    
+    for (int index = 0; index < 4; index++)
+    {
+        // 0000: JMP 0000
+        auto memory = std::make_shared<Ram>();
+        memory -> load(0x0000, { 0xC3, 0x00, 0x00 });
+        
+        auto cpu = std::make_unique<Cpu>();
+        cpu -> connect(memory);
+        
+        fleet.add(std::move(cpu));
+    }
+    
+    fleet.setPinning(true);
+    fleet.run(10000);
+    
+    pthread_getaffinity_np(pthread_self(), sizeof(after), &after);
+    
+    return CPU_EQUAL(&before, &after) && fleet.getCycles() == 4 * 10000;
+}
+#endif
+
+// Edges survive growing of the table and are counted apart
+static bool profilerEdges()
+{
+    auto profiler = std::make_unique<Profiler>();
+    
+    for (uint16_t source = 0; source < 3000; source++)
+    {
+        for (uint16_t times = 0; times <= source % 3; times++) {
+            profiler -> call(source, source + 1);
+        }
+    }
+    
+    profiler -> ret(1, 0);
+    
+    std::string path = "profiler.edges";
+    
+    if (!profiler -> dump(path)) {
+        return false;
+    }
+    
+    std::ifstream file(path, std::ios::binary);
+    file.seekg(8 + (256 + 0x10000) * 2 * sizeof(uint64_t));
+    
+    uint64_t count = 0, total = 0;
+    file.read((char *) &count, sizeof(count));
+    
+    bool valid = count == 3000;
+    
+    for (uint64_t index = 0; index < count; index++)
+    {
+        uint16_t source, target;
+        uint64_t times;
+        
+        file.read((char *) &source, sizeof(source));
+        file.read((char *) &target, sizeof(target));
+        file.read((char *) &times,  sizeof(times));
+        
+        valid &= target == (uint16_t) (source + 1) && times == (uint64_t) (source % 3 + 1);
+        total += times;
+    }
+    
+    file.read((char *) &count, sizeof(count));
+    file.close();
+    
+    std::remove(path.c_str());
+    
+    return valid && file && count == 1 && total == 6000;
+}
+
+using Image = std::vector<std::pair<uint16_t, std::vector<uint8_t>>>;
+
+// Program halts in the same state interpreted,
+// from cache without and with fused pairs
+static bool fusedSame(const Image & image)
+{
+    Cpu cpus[3];
+    
+    for (int index = 0; index < 3; index++)
+    {
+        auto ram = std::make_shared<Ram>();
+        
+        for (auto & part : image) {
+            ram -> load(part.first, part.second);
+        }
+        
+        cpus[index].connect(ram);
+    }
+    
+    cpus[1].enableCache(false);
+    cpus[2].enableCache(true);
+    
+    for (auto & cpu : cpus) {
+        cpu.run(100000);
+    }
+    
+    return cpus[0].isHalted() && same(cpus[0], cpus[1]) && same(cpus[0], cpus[2]);
+}
+
+// Targets of CALL and JNZ following MVI and DCR
+// are rewritten from other block and the same block
+static bool fusedModified()
+{
+    return fusedSame(
+    {
+        { 0x0000, {
+            0x31, 0x00, 0xF0,   // 0000: LXI  SP, F000
+            0x06, 0x03,         // 0003: MVI  B, 03
+            0x0E, 0x07,         // 0005: MVI  C, 07
+            0xCD, 0x40, 0x00,   // 0007: CALL 0040
+            0x21, 0x08, 0x00,   // 000A: LXI  H, 0008
+            0x36, 0x50,         // 000D: MVI  M, 50     ; CALL 0050
+            0x2E, 0x15,         // 000F: MVI  L, 15
+            0x36, 0x18,         // 0011: MVI  M, 18     ; JNZ  0018
+            0x05,               // 0013: DCR  B
+            0xC2, 0x05, 0x00,   // 0014: JNZ  0005
+            0x76,               // 0017: HLT
+            0xC3, 0x05, 0x00    // 0018: JMP  0005
+        }},
+        { 0x0040, {
+            0x81,               // 0040: ADD  C
+            0xC9                // 0041: RET
+        }},
+        { 0x0050, {
+            0x91,               // 0050: SUB  C
+            0x3C,               // 0051: INR  A
+            0xC9                // 0052: RET
+        }}
+    });
+}
+
+// DCR and JNZ are split by page end, INR and JNZ by
+// block length. JNZ after DCR is entered by JMP as well
+static bool fusedSplit()
+{
+    bool passed = fusedSame(
+    {
+        { 0x0000, {
+            0x31, 0x00, 0xF0,   // 0000: LXI  SP, F000
+            0x16, 0x05,         // 0003: MVI  D, 05
+            0xC3, 0xFC, 0x00    // 0005: JMP  00FC
+        }},
+        { 0x00FC, {
+            0x00, 0x00, 0x00,   // 00FC: NOP x 3
+            0x15,               // 00FF: DCR  D
+            0xC2, 0xFC, 0x00,   // 0100: JNZ  00FC
+            0x1E, 0xFC          // 0103: MVI  E, FC
+        }},
+        { 0x0105, std::vector<uint8_t>(31, 0x00) },
+        { 0x0124, {
+            0x1C,               // 0124: INR  E
+            0xC2, 0x05, 0x01,   // 0125: JNZ  0105
+            0x76                // 0128: HLT
+        }}
+    });
+    
+    return passed && fusedSame(
+    {
+        { 0x0000, {
+            0x06, 0x03,         // 0000: MVI  B, 03
+            0x05,               // 0002: DCR  B
+            0xC2, 0x0A, 0x00,   // 0003: JNZ  000A
+            0x76,               // 0006: HLT
+            0x00, 0x00, 0x00,
+            0x05,               // 000A: DCR  B
+            0xC3, 0x03, 0x00    // 000B: JMP  0003
+        }}
+    });
+}
+
+// Call BDOS function with address in DE, return A
+static uint8_t call(Cpu & cpu, Bdos & bdos, uint8_t function, uint16_t address = 0x0000)
+{
+    cpu.setRegister(Cpu::C, function);
+    cpu.setPair(Cpu::DE, address);
+    
+    bdos.call(cpu);
+    
+    return cpu.getRegister(Cpu::A);
+}
+
+// FCB of 11 characters of name and type with zero position
+static void fcb(Cpu & cpu, uint16_t address, const std::string & name)
+{
+    for (uint16_t i = 0; i < 36; i++) {
+        cpu.setMemory(address + i, 0x00);
+    }
+    
+    for (uint16_t i = 0; i < 11; i++) {
+        cpu.setMemory(address + 1 + i, (uint8_t) name[i]);
+    }
+}
+
+// Empty host directory removed with its files
+struct Folder
+{
+    std::string path;
+    
+    Folder()
+    {
+        char pattern[] = "/tmp/bdos.XXXXXX";
+        path = mkdtemp(pattern);
+    }
+    
+    bool empty() const
+    {
+        auto folder = opendir(path.c_str());
+        int files = 0;
+        
+        while (auto entry = readdir(folder)) {
+            files += entry -> d_name[0] != '.';
+        }
+        
+        closedir(folder);
+        return files == 0;
+    }
+    
+    ~Folder()
+    {
+        std::remove((path + "/test.txt").c_str());
+        std::remove((path + "/new.txt").c_str());
+        
+        rmdir(path.c_str());
+    }
+};
+
+// File made and written by records is read back
+// in the same records and found by its new name
+static bool bdosFiles()
+{
+    Folder folder;
+    
+    auto ram  = std::make_shared<Ram>();
+    auto bdos = std::make_shared<Bdos>(std::make_shared<Console>(std::make_shared<Text>()), folder.path);
+    
+    Cpu cpu;
+    cpu.connect(ram);
+    
+    fcb(cpu, 0x005C, "TEST    TXT");
+    
+    bool passed = call(cpu, *bdos, 0x16, 0x005C) == 0x00; // Make file
+    
+    for (uint8_t record = 0; record < 2; record++)
+    {
+        for (uint16_t i = 0; i < 128; i++) {
+            cpu.setMemory(0x0080 + i, (uint8_t) (record * 128 + i));
+        }
+        
+        passed &= call(cpu, *bdos, 0x15, 0x005C) == 0x00; // Write sequential
+    }
+    
+    passed &= call(cpu, *bdos, 0x10, 0x005C) == 0x00; // Close file
+    
+    fcb(cpu, 0x005C, "TEST    TXT");
+    
+    passed &= call(cpu, *bdos, 0x0F, 0x005C) == 0x00; // Open file
+    passed &= cpu.getMemory(0x005C + 15) == 2;         // Records in extent
+    
+    for (uint8_t record = 0; record < 2; record++)
+    {
+        passed &= call(cpu, *bdos, 0x14, 0x005C) == 0x00; // Read sequential
+        
+        for (uint16_t i = 0; i < 128; i++) {
+            passed &= cpu.getMemory(0x0080 + i) == (uint8_t) (record * 128 + i);
+        }
+    }
+    
+    passed &= call(cpu, *bdos, 0x14, 0x005C) == 0x01; // End of file
+    passed &= call(cpu, *bdos, 0x10, 0x005C) == 0x00;
+    
+    // Rename file, the new name follows the old one
+    fcb(cpu, 0x005C, "TEST    TXT");
+    
+    for (uint16_t i = 0; i < 11; i++) {
+        cpu.setMemory(0x005C + 17 + i, (uint8_t) "NEW     TXT"[i]);
+    }
+    
+    passed &= call(cpu, *bdos, 0x17, 0x005C) == 0x00;
+    
+    fcb(cpu, 0x005C, "TEST    TXT");
+    passed &= call(cpu, *bdos, 0x0F, 0x005C) == 0xFF;
+    
+    // Search for first returns entry of the new name in buffer
+    fcb(cpu, 0x005C, "????????TXT");
+    passed &= call(cpu, *bdos, 0x11, 0x005C) == 0x00;
+    
+    for (uint16_t i = 0; i < 11; i++) {
+        passed &= cpu.getMemory(0x0080 + 1 + i) == (uint8_t) "NEW     TXT"[i];
+    }
+    
+    passed &= cpu.getMemory(0x0080 + 15) == 2;
+    passed &= call(cpu, *bdos, 0x12) == 0xFF; // Search for next
+    
+    return passed;
+}
+
+// Names with characters outside of CP/M set make and rename
+// nothing, string without '$' is printed up to 64 KB
+static bool bdosNames()
+{
+    Folder folder;
+    
+    auto ram  = std::make_shared<Ram>();
+    auto text = std::make_shared<Text>();
+    auto console = std::make_shared<Console>(text);
+    auto bdos = std::make_shared<Bdos>(console, folder.path);
+    
+    Cpu cpu;
+    cpu.connect(ram);
+    
+    bool passed = true;
+    
+    for (auto name : { "../TEST TXT", "A/B     TXT", "A\\B     TXT", "TE\x01T    TXT", "TE ST   TXT", "        TXT" })
+    {
+        fcb(cpu, 0x005C, name);
+        passed &= call(cpu, *bdos, 0x16, 0x005C) == 0xFF;
+    }
+    
+    passed &= folder.empty();
+    
+    fcb(cpu, 0x005C, "TEST    TXT");
+    passed &= call(cpu, *bdos, 0x16, 0x005C) == 0x00;
+    passed &= call(cpu, *bdos, 0x10, 0x005C) == 0x00;
+    
+    for (uint16_t i = 0; i < 11; i++) {
+        cpu.setMemory(0x005C + 17 + i, (uint8_t) "../NEW  TXT"[i]);
+    }
+    
+    passed &= call(cpu, *bdos, 0x17, 0x005C) == 0xFF;
+    passed &= call(cpu, *bdos, 0x0F, 0x005C) == 0x00;
+    
+    // Memory is filled with zeros
+    call(cpu, *bdos, 0x09, 0x0100);
+    console -> flush();
+    
+    return passed && text -> text.size() == 0x10000;
+}
+
+struct Case
+{
+    std::string name;
+    std::function<bool()> check;
+};
+
+static const std::vector<Case> cases
+{
+    { "scheduler: event from port",          [] { return scheduledByPort(false, false); } },
+    { "scheduler: event from port, cache",   [] { return scheduledByPort(true,  false); } },
+    { "scheduler: event from port, halted",  [] { return scheduledByPort(false, true);  } },
+    { "scheduler: event from port, halted, cache", [] { return scheduledByPort(true, true); } },
+    { "interrupt: accepted after EI",              [] { return interruptAfterEnable(false); } },
+    { "interrupt: accepted after EI, cache",       [] { return interruptAfterEnable(true);  } },
+    { "interrupt: wakes halted",                   [] { return interruptWakesHalted(false); } },
+    { "interrupt: wakes halted, cache",            [] { return interruptWakesHalted(true);  } },
+    { "memory map: stores by page kind",           [] { return mappedStores(false); } },
+    { "memory map: stores by page kind, cache",    [] { return mappedStores(true);  } },
+    { "memory map: banks switched by port",        [] { return switchedBanks(false); } },
+    { "memory map: banks switched by port, cache", [] { return switchedBanks(true);  } },
+    { "status: eager and lazy policies",           statusPolicies },
+    { "throttle: cycles paced to frequency",       throttlePacing },
+    { "batch: halted lane",                        batchHalted },
+    { "batch: lanes in lockstep",                  batchSame },
+    { "batch: lanes with other programs",          batchPrograms },
+    { "batch: lanes with other data",              batchData },
+    { "cache: store into the middle of block",     partialInvalidation },
+    { "fusion: rewritten operands",                fusedModified },
+    { "fusion: pairs split by blocks",             fusedSplit },
+    { "bdos: make, read and rename file",          bdosFiles },
+    { "bdos: rejected names",                      bdosNames },
+    { "fleet: repeated runs",                      fleetRuns },
+#ifdef __linux__
+    { "fleet: affinity of calling thread",         fleetPinning },
+#endif
+    { "template: final bus",                       [] { return templateBus(false); } },
+    { "template: final bus, cache",                [] { return templateBus(true);  } },
+    { "profiler: call edges",                      profilerEdges },
+    { "cache: 8080PRE stopped by step()",          [] { return cachedSame("8080PRE.com", true);  } },
+    { "cache: 8080PRE stopped by run()",           [] { return cachedSame("8080PRE.com", false); } },
+    { "cache: CPUTEST stopped by run()",           [] { return cachedSame("CPUTEST.com", false); } },
+    { "exerciser: CPUTEST, cache",                 [] { return exerciser("CPUTEST.com", "CPU TESTS OK"); } },
+    { "exerciser: 8080PRE, cache",                 [] { return exerciser("8080PRE.com", "8080 Preliminary tests complete"); } },
+    { "exerciser: 8080, cache",                    [] { return exerciser("8080.com", "CPU IS OPERATIONAL"); } },
+#ifdef JIT
+    { "jit: translated operations",                jitOperations },
+    { "jit: flags of arithmetic",                  jitFlags },
+    { "jit: store to decoded code",                jitModifiedCode },
+    { "jit: device registers",                     jitMappedMemory },
+#endif
+#if !defined(ASMLOG) && !defined(PROFILE)
+    { "cache: idle loop after unrelated state",    idleAfterEntry },
+#endif
+#ifdef ASMLOG
+    { "trace: clock before operation",             traceClock },
+    { "trace: device registers are not read",      traceDevices },
+#endif
+};
+
+#pragma mark -
+#pragma mark Main
+
+// Usage: tests [folder with exercisers]
+int main(int argc, char ** argv)
+{
+    int failed = 0;
+    
+    if (argc > 1) {
+        folder = argv[1];
+    }
+    
+    for (auto & test : cases)
+    {
+        bool passed = test.check();
+        
+        std::cout << (passed ? "passed  " : "FAILED  ") << test.name << std::endl;
+        failed += !passed;
+    }
+    
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#ifdef __linux__
+#include <cerrno>
+#include <time.h>
+#endif
+
+#include "throttle.hpp"
+
+Throttle::Throttle(Cpu & cpu, double frequency) : cpu(cpu), frequency(std::max(frequency, 1.0))
+{
+    
+}
+
+void Throttle::setFrequency(double hertz)
+{
+    frequency = std::max(hertz, 1.0);
+    restart();
+}
+
+void Throttle::setSlice(uint64_t cycles)
+{
+    slice = std::max<uint64_t>(cycles, 1);
+}
+
+void Throttle::setTolerance(uint64_t nanoseconds)
+{
+    tolerance = nanoseconds;
+}
+
+void Throttle::restart()
+{
+    started = false;
+}
+
+const Throttle::Statistics & Throttle::getStatistics() const
+{
+    return statistics;
+}
+
+#pragma mark -
+#pragma mark Execution
+
+uint64_t Throttle::run(uint64_t cycles)
+{
+    uint64_t spent = 0;
+    
+    if (!started)
+    {
+        origin = now();
+        this -> cycles = 0;
+        started = true;
+    }
+    
+    while (spent < cycles)
+    {
+        uint64_t executed = cpu.run(std::min(slice, cycles - spent));
+        
+        spent += executed;
+        this -> cycles += executed;
+        statistics.slices++;
+        
+        uint64_t target = deadline();
+        uint64_t time = now();
+        
+        if (time < target)
+        {
+            statistics.lag = 0;
+            statistics.sleeps++;
+            
+            sleep(target);
+            
+            time = now();
+            uint64_t overslept = time > target ? time - target : 0;
+            
+            statistics.jitter += overslept;
+            statistics.maxJitter = std::max(statistics.maxJitter, overslept);
+        }
+        else
+        {
+            statistics.lag = time - target;
+            statistics.maxLag = std::max(statistics.maxLag, statistics.lag);
+            statistics.late++;
+            
+            // Host can't keep up, running faster
+            // to catch up would be worse than lag
+            if (statistics.lag > tolerance)
+            {
+                origin = time;
+                this -> cycles = 0;
+                statistics.resyncs++;
+            }
+        }
+    }
+    
+    return spent;
+}
+
+uint64_t Throttle::deadline() const
+{
+    return origin + (uint64_t) (cycles * 1e9 / frequency);
+}
+
+#pragma mark -
+#pragma mark Host clock
+
+uint64_t Throttle::now()
+{
+#ifdef __linux__
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    
+    return (uint64_t) time.tv_sec * 1000000000 + time.tv_nsec;
+#else
+    auto time = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+#endif
+}
+
+void Throttle::sleep(uint64_t deadline)
+{
+#ifdef __linux__
+    timespec time;
+    time.tv_sec  = deadline / 1000000000;
+    time.tv_nsec = deadline % 1000000000;
+    
+    // Absolute deadline survives interruption by signal
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &time, nullptr) == EINTR);
+#else
+    auto time = std::chrono::nanoseconds(deadline);
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(time));
+#endif
+}
@@ -0,0 +1,92 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THROTTLE_HPP
+#define THROTTLE_HPP
+
+#include <cstdint>
+
+#include "cpu.hpp"
+
+// Paces processor to clock frequency of real part: runs
+// slice of cycles, then sleeps until the moment the slice
+// would end on hardware. Deadlines are counted from start
+// of schedule, so oversleeping doesn't accumulate
+class Throttle
+{
+public:
+    
+    struct Statistics
+    {
+        uint64_t slices    = 0; // Slices executed
+        uint64_t sleeps    = 0; // Slices finished ahead of schedule
+        uint64_t late      = 0; // Slices finished behind schedule
+        uint64_t resyncs   = 0; // Schedule restarts after falling behind
+        uint64_t lag       = 0; // Nanoseconds behind after last slice
+        uint64_t maxLag    = 0; // Largest lag
+        uint64_t jitter    = 0; // Nanoseconds woken past deadlines
+        uint64_t maxJitter = 0; // Largest single oversleep
+    };
+    
+private:
+    
+    Cpu & cpu;
+    
+    double frequency;
+    
+    // Cycles per slice, 10 ms at 2 MHz
+    uint64_t slice = 20000;
+    
+    // Lag dropped instead of caught up, nanoseconds
+    uint64_t tolerance = 100000000;
+    
+    // Host time of schedule start and cycles since it
+    uint64_t origin = 0;
+    uint64_t cycles = 0;
+    
+    bool started = false;
+    
+    Statistics statistics;
+    
+    uint64_t deadline() const;
+    
+    // Monotonic host clock, nanoseconds
+    static uint64_t now();
+    static void sleep(uint64_t deadline);
+    
+public:
+    
+    Throttle(Cpu & cpu, double frequency = 2000000);
+    
+    // Frequency change starts schedule over
+    void setFrequency(double hertz);
+    
+    // Longer slices wake host less often, shorter
+    // ones keep devices closer to real time
+    void setSlice    (uint64_t cycles);
+    void setTolerance(uint64_t nanoseconds);
+    
+    // Execute cycles in real time
+    uint64_t run(uint64_t cycles);
+    
+    // Forget schedule, e.g. after emulation was paused
+    void restart();
+    
+    const Statistics & getStatistics() const;
+};
+
+#endif /* THROTTLE_HPP */
@@ -0,0 +1,119 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <fstream>
+
+#include "asmlog.hpp"
+#include "trace.hpp"
+
+Trace::Trace(std::size_t capacity)
+{
+    resize(capacity);
+}
+
+void Trace::resize(std::size_t capacity)
+{
+    std::size_t size = 1;
+    
+    while (size < capacity) {
+        size <<= 1;
+    }
+    
+    records.assign(size, Record());
+    
+    mask = size - 1;
+    written = 0;
+}
+
+void Trace::clear()
+{
+    written = 0;
+}
+
+uint8_t Trace::peek(const Pages & pages, uint16_t address)
+{
+    auto page = pages.read[address >> 8];
+    return page ? page[address & 0xFF] : 0x00;
+}
+
+std::size_t Trace::size() const
+{
+    return (std::size_t) std::min<uint64_t>(written, records.size());
+}
+
+const Record & Trace::operator[] (std::size_t index) const
+{
+    return records[(written - size() + index) & mask];
+}
+
+uint64_t Trace::total() const
+{
+    return written;
+}
+
+void Trace::print(std::ostream & out, std::size_t count) const
+{
+    auto size = this -> size();
+    
+    for (std::size_t index = size - std::min(count, size); index < size; index++) {
+        Asmlog::print(out, (*this)[index]);
+    }
+    
+    out.flush();
+}
+
+#pragma mark -
+#pragma mark Files
+
+bool Trace::save(const std::string & path) const
+{
+    std::ofstream file(path, std::ios::out | std::ios::binary);
+    
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    for (std::size_t index = 0; index < size(); index++) {
+        file.write((const char *) &(*this)[index], sizeof(Record));
+    }
+    
+    return file.good();
+}
+
+bool Trace::load(const std::string & path)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    file.seekg(0, std::ios::end);
+    auto count = (std::size_t) file.tellg() / sizeof(Record);
+    file.seekg(0, std::ios::beg);
+    
+    resize(count);
+    
+    Record record;
+    
+    while (file.read((char *) &record, sizeof(Record))) {
+        append(record);
+    }
+    
+    return true;
+}
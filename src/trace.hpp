@@ -0,0 +1,136 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "memory.hpp"
+
+// State after executed operation
+struct Record
+{
+    uint64_t clock;          // Clock before operation
+    uint16_t counter;        // Address of operation
+    uint16_t stack;          // Stack pointer
+    uint8_t  registers[8];   // B, C, D, E, H, L, -, A
+    uint8_t  opcode;
+    uint8_t  operands[2];    // Bytes following operation code
+    uint8_t  value;          // Memory at direct address
+    uint8_t  memory[3];      // Memory at BC, DE and HL
+    uint8_t  status;
+    uint8_t  reserved[4];
+};
+
+static_assert(sizeof(Record) == 32, "Trace record is 32 bytes");
+
+// Last executed operations kept in preallocated ring buffer.
+// Text is produced only when the trace is printed
+class Trace
+{
+private:
+    
+    std::vector<Record> records;
+    
+    // Records ever appended
+    uint64_t written = 0;
+    
+    // Capacity is power of two
+    uint64_t mask = 0;
+    
+    // Memory through direct pages only, reading
+    // device registers may change devices
+    static uint8_t peek(const Pages & pages, uint16_t address);
+    
+public:
+    
+    Trace(std::size_t capacity = 1 << 20);
+    
+    // Drops recorded operations
+    void resize(std::size_t capacity);
+    void clear();
+    
+    // Capture operation just executed by cpu,
+    // clock is taken before the operation
+    template <class Processor>
+    void record(uint16_t counter, uint64_t clock, const Processor & cpu);
+    void append(const Record & record);
+    
+    // Retained records, the oldest first
+    std::size_t size() const;
+    const Record & operator[] (std::size_t index) const;
+    
+    // Operations recorded since creation
+    uint64_t total() const;
+    
+    // The last count records in Asmlog format
+    void print(std::ostream & out, std::size_t count = SIZE_MAX) const;
+    
+    // Raw records in host byte order, the oldest first
+    bool save(const std::string & path) const;
+    bool load(const std::string & path);
+};
+
+inline void Trace::append(const Record & record)
+{
+    records[written++ & mask] = record;
+}
+
+// Memory is read after the operation and only where it is shown.
+// Pages of memory mapped devices are shown as zero
+template <class Processor>
+void Trace::record(uint16_t counter, uint64_t clock, const Processor & cpu)
+{
+    auto & command = Processor::commands[cpu.opcode];
+    auto & pages = *cpu.pages;
+    
+    Record record {};
+    
+    record.clock   = clock;
+    record.counter = counter;
+    record.stack   = cpu.stack;
+    record.opcode  = cpu.opcode;
+    record.status  = cpu.status;
+    
+    std::memcpy(record.registers, cpu.registers, sizeof(record.registers));
+    
+    if (command.isIndirect())
+    {
+        record.operands[0] = peek(pages, counter + 1);
+        record.operands[1] = peek(pages, counter + 2);
+        
+        record.value = peek(pages, (record.operands[1] << 8) | record.operands[0]);
+    }
+    else if (command.isImmediate())
+    {
+        record.operands[0] = peek(pages, counter + 1);
+    }
+    
+    record.memory[0] = peek(pages, cpu.readpair(Processor::BC));
+    record.memory[1] = peek(pages, cpu.readpair(Processor::DE));
+    record.memory[2] = peek(pages, cpu.readpair(Processor::HL));
+    
+    append(record);
+}
+
+#endif /* TRACE_HPP */
@@ -0,0 +1,116 @@
+/*
+ * This file is part of the 8080 distribution (https://github.com/temaweb/8080).
+ * Copyright (c) 2020 Artem Okonechnikov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRAP_HPP
+#define TRAP_HPP
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+#include "cpufwd.hpp"
+
+// Host handler executed instead of guest subroutine
+template <class Processor>
+class BasicTrap
+{
+public:
+    // Called after return address is popped from stack,
+    // handler may set counter to continue elsewhere
+    virtual void call(Processor & cpu) = 0;
+    
+    virtual ~BasicTrap() = default;
+};
+
+using Trap = BasicTrap<Cpu>;
+
+// Trapped addresses, checked before every operation
+class Traps
+{
+private:
+    // Bit per address
+    uint8_t bitmap[64 * 1024 / 8] {};
+    
+protected:
+    void mark  (uint16_t address);
+    void unmark(uint16_t address);
+    
+public:
+    bool contains(uint16_t address) const;
+    
+    virtual ~Traps() = default;
+};
+
+// Handlers of trapped addresses
+template <class Processor>
+class BasicTraps : public Traps
+{
+private:
+    std::unordered_map<uint16_t, std::shared_ptr<BasicTrap<Processor>>> handlers;
+    
+public:
+    // Handler of trapped address, shared while it runs
+    std::shared_ptr<BasicTrap<Processor>> find(uint16_t address) const;
+    
+    void add   (uint16_t address, std::shared_ptr<BasicTrap<Processor>> trap);
+    void remove(uint16_t address);
+    
+    bool empty() const;
+};
+
+inline void Traps::mark(uint16_t address)
+{
+    bitmap[address >> 3] |= (1 << (address & 0x07));
+}
+
+inline void Traps::unmark(uint16_t address)
+{
+    bitmap[address >> 3] &= ~(1 << (address & 0x07));
+}
+
+inline bool Traps::contains(uint16_t address) const
+{
+    return bitmap[address >> 3] & (1 << (address & 0x07));
+}
+
+template <class Processor>
+std::shared_ptr<BasicTrap<Processor>> BasicTraps<Processor>::find(uint16_t address) const
+{
+    return handlers.at(address);
+}
+
+template <class Processor>
+void BasicTraps<Processor>::add(uint16_t address, std::shared_ptr<BasicTrap<Processor>> trap)
+{
+    handlers[address] = std::move(trap);
+    mark(address);
+}
+
+template <class Processor>
+void BasicTraps<Processor>::remove(uint16_t address)
+{
+    handlers.erase(address);
+    unmark(address);
+}
+
+template <class Processor>
+bool BasicTraps<Processor>::empty() const
+{
+    return handlers.empty();
+}
+
+#endif /* TRAP_HPP */